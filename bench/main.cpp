@@ -0,0 +1,793 @@
+#include "../bigInt.h"
+#include "../miller_rabin.h"
+#include "../montgomery.h"
+#include "../rsa_ops.h"
+#include "../solvers.h"
+#include "../perf_counters.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <filesystem>
+#include <map>
+#include <cmath>
+#include <cctype>
+
+// Microbenchmarks for the BigInt kernels, in the spirit of Google Benchmark:
+// each case is repeated until it has run for --min-time seconds, then reported
+// as ns/op, heap allocations/op and throughput. Output is a console table or
+// the Google Benchmark JSON layout (--format json).
+//
+//     bench [--filter <substring>] [--min-time <seconds>] [--max-bits <bits>]
+//           [--perf] [--format console|json] [--out <file>]
+//
+// --perf also reads the thread's hardware counters (perf_counters.h) over each
+// case's final timed run and reports IPC, branch misses, cache misses per limb
+// operation and stalled-cycle shares, to tell frontend-bound kernels (the
+// branchy bit loop of divmod) from memory-bound ones. A limb operation is the
+// nominal schoolbook / bit-serial work of the kernel, e.g. n^2 for an n-limb
+// product, so the per-limb-op figures compare across sizes.
+//
+// With --corpus <repo_root>, it instead replays every project_01_0X/test/*.inp
+// through the project solvers in-process, --repeat times each, and reports
+// per-case latency percentiles, throughput, and whether the answer matches
+// the case's .out file.
+//
+// With --alloc-check, it warms up the kernels that must not touch the heap in
+// steady state (Montgomery multiply, Montgomery powmod into a reused BigInt,
+// one Miller-Rabin round), then fails unless their next calls allocate nothing.
+//
+// With --scaling, it sweeps the operand size geometrically (--steps-per-octave
+// sizes per doubling) for mul, sqr, divmod, powmod and bezout, fits log(ns)
+// against log(bits), and reports the measured complexity exponent, the size ranges
+// ("tiers") where the slope changes, and whether the largest tier is slower than
+// the kernel's model exponent, e.g. a quadratic fallback where a subquadratic
+// path should have taken over.
+
+// --- Allocation counting: every heap allocation of this process goes through here ---
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // free() is the right match for the malloc() below
+#endif
+static std::atomic<uint64_t> alloc_count(0);
+static std::atomic<uint64_t> alloc_bytes(0);
+
+void* operator new(std::size_t size) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// Keeps the compiler from discarding a result it can see is unused
+template <typename T>
+static void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult {
+    std::string name;
+    size_t bits;
+    uint64_t iterations;
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_alloc_per_op;
+    double ops_per_sec;
+    double operand_mb_per_sec;  // operand bytes consumed per second
+    double limb_ops;            // nominal limb operations per call
+    PerfSample perf;            // per call; nothing available without --perf
+};
+
+struct BenchCase {
+    std::string kernel;
+    size_t default_max_bits;    // the bit-serial kernels are cubic; skip huge sizes unless asked
+    double (*limb_ops)(double limbs);
+    // Builds operands for `bits` and returns the operation to time
+    std::function<std::function<void()>(size_t bits, std::mt19937_64& gen)> setup;
+};
+
+static BigInt random_bits(size_t bits, std::mt19937_64& gen) {
+    BigInt r;
+    r.limbs.assign((bits + 63) / 64, 0);
+    for (auto& limb : r.limbs) limb = gen();
+    size_t top = bits % 64;
+    if (top > 0) r.limbs.back() &= (1ULL << top) - 1;
+    r.limbs.back() |= 1ULL << ((bits - 1) % 64); // Exactly `bits` bits long
+    r.normalize();
+    return r;
+}
+
+static BigInt random_odd_bits(size_t bits, std::mt19937_64& gen) {
+    BigInt r = random_bits(bits, gen);
+    r.limbs[0] |= 1;
+    return r;
+}
+
+// Operands of one case depend only on its kernel and size, so --filter and
+// --max-bits do not change what the remaining cases measure
+static std::mt19937_64 case_generator(const std::string& kernel, size_t bits) {
+    std::vector<uint32_t> key(kernel.begin(), kernel.end());
+    key.push_back(static_cast<uint32_t>(bits));
+    key.push_back(20240917);
+    std::seed_seq seed(key.begin(), key.end());
+    return std::mt19937_64(seed);
+}
+
+static std::vector<BenchCase> make_cases() {
+    std::vector<BenchCase> cases;
+    // Each case: kernel, default size cap, nominal limb operations for n limbs, setup
+    cases.push_back({"add", 16384, [](double n) { return n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen), b = random_bits(bits, gen);
+        return std::function<void()>([a, b] { do_not_optimize(a + b); });
+    }});
+    cases.push_back({"sub", 16384, [](double n) { return n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen), b = random_bits(bits - 1, gen);
+        return std::function<void()>([a, b] { do_not_optimize(a - b); });
+    }});
+    cases.push_back({"mul", 16384, [](double n) { return n * n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen), b = random_bits(bits, gen);
+        return std::function<void()>([a, b] { do_not_optimize(a * b); });
+    }});
+    cases.push_back({"sqr", 16384, [](double n) { return n * n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen);
+        return std::function<void()>([a] { do_not_optimize(a * a); });
+    }});
+    // Limb operations: one n-limb step per quotient bit
+    cases.push_back({"divmod", 4096, [](double n) { return 64 * n * n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(2 * bits, gen), b = random_bits(bits, gen);
+        return std::function<void()>([a, b] { do_not_optimize(BigInt::divmod(a, b)); });
+    }});
+    cases.push_back({"shl", 16384, [](double n) { return n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen);
+        return std::function<void()>([a] { do_not_optimize(a << 77); });
+    }});
+    cases.push_back({"shr", 16384, [](double n) { return n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen);
+        return std::function<void()>([a] { do_not_optimize(a >> 77); });
+    }});
+    // Limb operations: about 80n Montgomery products (squarings plus window multiplies) of 2n^2
+    cases.push_back({"powmod", 4096, [](double n) { return 80 * n * 2 * n * n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt n = random_odd_bits(bits, gen), k = random_bits(bits, gen), x = random_bits(bits - 1, gen);
+        return std::function<void()>([n, k, x] { do_not_optimize(powMod(x, k, n)); });
+    }});
+    // Limb operations: interleaved product and reduction
+    cases.push_back({"montgomery_mul", 16384, [](double n) { return 2 * n * n; }, [](size_t bits, std::mt19937_64& gen) {
+        auto context = std::make_shared<MontgomeryContext>(random_odd_bits(bits, gen));
+        auto a = std::make_shared<LimbVector>(context->limbs()), b = std::make_shared<LimbVector>(context->limbs());
+        context->to_montgomery(random_bits(bits - 1, gen), a->data());
+        context->to_montgomery(random_bits(bits - 1, gen), b->data());
+        return std::function<void()>([context, a, b] {
+            context->mul(a->data(), b->data(), a->data());
+            do_not_optimize((*a)[0]);
+        });
+    }});
+    // Limb operations: one powmod
+    cases.push_back({"miller_rabin_round", 4096, [](double n) { return 80 * n * 2 * n * n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt n = random_odd_bits(bits, gen);
+        return std::function<void()>([n] { do_not_optimize(is_prime_miller_rabin(n, 1)); });
+    }});
+    // Limb operations: about one n-limb step per bit
+    cases.push_back({"bezout", 4096, [](double n) { return 64 * n * n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen), b = random_bits(bits, gen);
+        return std::function<void()>([a, b] {
+            BigInt x, y;
+            do_not_optimize(bezout(a, b, x, y));
+        });
+    }});
+    cases.push_back({"hex_parse", 16384, [](double n) { return n; }, [](size_t bits, std::mt19937_64& gen) {
+        std::string hex = random_bits(bits, gen).to_reversed_hex_string();
+        return std::function<void()>([hex] { do_not_optimize(BigInt::from_reversed_hex(hex)); });
+    }});
+    cases.push_back({"hex_format", 16384, [](double n) { return n; }, [](size_t bits, std::mt19937_64& gen) {
+        BigInt a = random_bits(bits, gen);
+        return std::function<void()>([a] { do_not_optimize(a.to_reversed_hex_string()); });
+    }});
+    return cases;
+}
+
+// Grows the iteration count until one run lasts min_time, like Google Benchmark
+static BenchResult run_case(const std::string& kernel, size_t bits, const std::function<void()>& op, double min_time,
+                            PerfCounters* perf = nullptr) {
+    op(); // Warm-up: first-touch page faults and lazy statics stay out of the numbers
+
+    uint64_t iterations = 1;
+    while (true) {
+        uint64_t allocs_before = alloc_count.load(), bytes_before = alloc_bytes.load();
+        if (perf) perf->start();
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) op();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        PerfSample sample = perf ? perf->stop() : PerfSample();
+        uint64_t allocs = alloc_count.load() - allocs_before;
+        uint64_t bytes = alloc_bytes.load() - bytes_before;
+
+        if (seconds >= min_time || iterations >= (1ULL << 30)) {
+            BenchResult r;
+            r.name = kernel + "/" + std::to_string(bits);
+            r.bits = bits;
+            r.iterations = iterations;
+            r.ns_per_op = seconds * 1e9 / iterations;
+            r.allocs_per_op = static_cast<double>(allocs) / iterations;
+            r.bytes_alloc_per_op = static_cast<double>(bytes) / iterations;
+            r.ops_per_sec = iterations / seconds;
+            r.operand_mb_per_sec = r.ops_per_sec * (bits / 8.0) / 1e6;
+            r.limb_ops = 0;
+            r.perf = sample;
+            for (double& v : r.perf.values) v /= iterations;
+            return r;
+        }
+        // Aim straight for min_time, with headroom, instead of doubling blindly
+        double scale = seconds > 0 ? 1.4 * min_time / seconds : 10.0;
+        iterations = std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+    }
+}
+
+static void write_json_context(std::ostream& out) {
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#if defined(__VERSION__)
+    out << "    \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+#if defined(NDEBUG)
+    out << "    \"library_build_type\": \"release\"\n";
+#else
+    out << "    \"library_build_type\": \"debug\"\n";
+#endif
+    out << "  },\n";
+}
+
+// Hardware counter figures derived from a result's per-call counts; NaN when unavailable
+struct PerfFigures {
+    double ipc, branch_misses, l1d_per_limb_op, llc_per_limb_op, frontend_stall, backend_stall, page_faults;
+};
+
+static PerfFigures perf_figures(const BenchResult& r) {
+    const PerfSample& p = r.perf;
+    const double na = std::nan("");
+    auto value = [&](PerfEvent e) { return p.available[e] ? p.values[e] : na; };
+    double cycles = value(PERF_CYCLES);
+    PerfFigures f;
+    f.ipc = value(PERF_INSTRUCTIONS) / cycles;
+    f.branch_misses = value(PERF_BRANCH_MISSES);
+    f.l1d_per_limb_op = value(PERF_L1D_MISSES) / r.limb_ops;
+    f.llc_per_limb_op = value(PERF_LLC_MISSES) / r.limb_ops;
+    f.frontend_stall = 100 * value(PERF_STALLED_FRONTEND) / cycles;
+    f.backend_stall = 100 * value(PERF_STALLED_BACKEND) / cycles;
+    f.page_faults = value(PERF_PAGE_FAULTS);
+    return f;
+}
+
+static void write_json_perf(std::ostream& out, const BenchResult& r) {
+    bool any = false;
+    for (bool available : r.perf.available) any = any || available;
+    if (!any) return;
+
+    PerfFigures f = perf_figures(r);
+    out << ", \"perf\": {";
+    bool first = true;
+    auto field = [&](const char* name, double v) {
+        if (std::isnan(v)) return;
+        out << (first ? "" : ", ") << "\"" << name << "\": " << v;
+        first = false;
+    };
+    for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (r.perf.available[e]) field(perf_event_names[e], r.perf.values[e]);
+    }
+    field("ipc", f.ipc);
+    field("l1d_misses_per_limb_op", f.l1d_per_limb_op);
+    field("llc_misses_per_limb_op", f.llc_per_limb_op);
+    field("frontend_stall_pct", f.frontend_stall);
+    field("backend_stall_pct", f.backend_stall);
+    out << "}";
+}
+
+static void write_json(std::ostream& out, const std::vector<BenchResult>& results) {
+    write_json_context(out);
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"bits\": " << r.bits
+            << ", \"iterations\": " << r.iterations
+            << ", \"real_time\": " << r.ns_per_op << ", \"time_unit\": \"ns\""
+            << ", \"allocs_per_op\": " << r.allocs_per_op
+            << ", \"bytes_allocated_per_op\": " << r.bytes_alloc_per_op
+            << ", \"items_per_second\": " << r.ops_per_sec
+            << ", \"operand_mb_per_second\": " << r.operand_mb_per_sec;
+        write_json_perf(out, r);
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static void write_console(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(16) << "ns/op"
+        << std::setw(14) << "allocs/op" << std::setw(14) << "ops/s" << std::setw(12) << "MB/s"
+        << std::setw(12) << "iters" << "\n";
+    out << std::string(96, '-') << "\n";
+    out << std::fixed << std::setprecision(1);
+    for (const BenchResult& r : results) {
+        out << std::left << std::setw(28) << r.name << std::right << std::setw(16) << r.ns_per_op
+            << std::setw(14) << r.allocs_per_op << std::setw(14) << r.ops_per_sec
+            << std::setw(12) << r.operand_mb_per_sec << std::setw(12) << r.iterations << "\n";
+    }
+}
+
+static void write_console_perf(std::ostream& out, const std::vector<BenchResult>& results) {
+    auto cell = [&](double v, int width) {
+        if (std::isnan(v)) out << std::setw(width) << "n/a";
+        else out << std::setw(width) << v;
+    };
+    out << "\n" << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(8) << "IPC"
+        << std::setw(14) << "br-miss/op" << std::setw(16) << "L1D/limb-op" << std::setw(16) << "LLC/limb-op"
+        << std::setw(10) << "FE stl%" << std::setw(10) << "BE stl%" << std::setw(12) << "faults/op" << "\n";
+    out << std::string(114, '-') << "\n";
+    for (const BenchResult& r : results) {
+        PerfFigures f = perf_figures(r);
+        out << std::left << std::setw(28) << r.name << std::right << std::setprecision(2);
+        cell(f.ipc, 8);
+        out << std::setprecision(1);
+        cell(f.branch_misses, 14);
+        out << std::setprecision(4);
+        cell(f.l1d_per_limb_op, 16);
+        cell(f.llc_per_limb_op, 16);
+        out << std::setprecision(1);
+        cell(f.frontend_stall, 10);
+        cell(f.backend_stall, 10);
+        out << std::setprecision(3);
+        cell(f.page_faults, 12);
+        out << "\n";
+    }
+}
+
+// --- Complexity scaling ---
+
+// Exponent each kernel should show at large sizes with the algorithms in bigInt.h
+static const std::map<std::string, double> scaling_models = {
+    {"mul", 1.585},     // Karatsuba above BigInt::karatsuba_mul_threshold
+    {"sqr", 1.585},     // Karatsuba above BigInt::karatsuba_sqr_threshold
+    {"divmod", 2.0},    // bit-serial shift-subtract: one O(n) step per quotient bit
+    {"powmod", 3.0},    // O(n) Montgomery products of O(n^2) each
+    {"bezout", 2.0},    // O(n) Euclid steps with mostly one-limb quotients
+};
+static const double scaling_tolerance = 0.25;
+
+struct LineFit {
+    double slope, intercept, sse;
+};
+
+// Least-squares line through points [lo, hi)
+static LineFit fit_line(const std::vector<double>& x, const std::vector<double>& y, size_t lo, size_t hi) {
+    double n = static_cast<double>(hi - lo), sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = lo; i < hi; ++i) {
+        sx += x[i];
+        sy += y[i];
+        sxx += x[i] * x[i];
+        sxy += x[i] * y[i];
+    }
+    double denom = n * sxx - sx * sx;
+    LineFit fit;
+    fit.slope = denom != 0 ? (n * sxy - sx * sy) / denom : 0;
+    fit.intercept = (sy - fit.slope * sx) / n;
+    fit.sse = 0;
+    for (size_t i = lo; i < hi; ++i) {
+        double r = y[i] - (fit.intercept + fit.slope * x[i]);
+        fit.sse += r * r;
+    }
+    return fit;
+}
+
+struct ScalingTier {
+    size_t first_bits, last_bits;
+    double exponent;
+};
+
+// Splits [lo, hi) into straight log-log segments: a split is kept when it halves
+// the squared error and the two slopes differ noticeably
+static void split_tiers(const std::vector<size_t>& bits, const std::vector<double>& x, const std::vector<double>& y,
+                        size_t lo, size_t hi, std::vector<ScalingTier>& tiers) {
+    const size_t min_points = 4;
+    const double min_slope_change = 0.3;
+    LineFit whole = fit_line(x, y, lo, hi);
+
+    size_t best = 0;
+    double best_sse = whole.sse;
+    for (size_t k = lo + min_points; k + min_points <= hi; ++k) {
+        LineFit left = fit_line(x, y, lo, k), right = fit_line(x, y, k, hi);
+        if (left.sse + right.sse < best_sse && std::fabs(left.slope - right.slope) >= min_slope_change) {
+            best = k;
+            best_sse = left.sse + right.sse;
+        }
+    }
+    if (best != 0 && best_sse < 0.5 * whole.sse) {
+        split_tiers(bits, x, y, lo, best, tiers);
+        split_tiers(bits, x, y, best, hi, tiers);
+        return;
+    }
+    tiers.push_back({bits[lo], bits[hi - 1], whole.slope});
+}
+
+struct ScalingResult {
+    std::string kernel;
+    double model, exponent;
+    std::vector<size_t> bits;
+    std::vector<double> ns_per_op;
+    std::vector<ScalingTier> tiers;
+    bool above_model;
+};
+
+static int run_scaling(const std::string& filter, double min_time, size_t max_bits, size_t steps_per_octave,
+                       const std::string& format, std::ostream& out) {
+    std::vector<ScalingResult> results;
+    for (const BenchCase& c : make_cases()) {
+        auto model = scaling_models.find(c.kernel);
+        if (model == scaling_models.end()) continue;
+        if (!filter.empty() && c.kernel.find(filter) == std::string::npos) continue;
+
+        ScalingResult res;
+        res.kernel = c.kernel;
+        res.model = model->second;
+        size_t cap = max_bits ? max_bits : c.default_max_bits;
+        std::vector<double> log_bits, log_ns;
+        for (size_t step = 0;; ++step) {
+            size_t bits = static_cast<size_t>(std::llround(64 * std::exp2(static_cast<double>(step) / steps_per_octave)));
+            if (bits > cap) break;
+            if (!res.bits.empty() && bits == res.bits.back()) continue;
+
+            std::mt19937_64 gen = case_generator(c.kernel, bits);
+            std::function<void()> op = c.setup(bits, gen);
+            BenchResult r = run_case(c.kernel, bits, op, min_time);
+            res.bits.push_back(bits);
+            res.ns_per_op.push_back(r.ns_per_op);
+            log_bits.push_back(std::log(static_cast<double>(bits)));
+            log_ns.push_back(std::log(r.ns_per_op));
+            std::cerr << r.name << ": " << r.ns_per_op << " ns/op" << std::endl;
+        }
+        if (res.bits.size() < 2) continue;
+
+        res.exponent = fit_line(log_bits, log_ns, 0, log_bits.size()).slope;
+        split_tiers(res.bits, log_bits, log_ns, 0, log_bits.size(), res.tiers);
+        res.above_model = res.tiers.back().exponent > res.model + scaling_tolerance;
+        results.push_back(res);
+    }
+
+    size_t above = 0;
+    for (const ScalingResult& r : results) above += r.above_model;
+
+    if (format == "json") {
+        write_json_context(out);
+        out << "  \"scaling\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const ScalingResult& r = results[i];
+            out << "    {\"kernel\": \"" << r.kernel << "\", \"model_exponent\": " << r.model
+                << ", \"exponent\": " << r.exponent << ", \"above_model\": " << (r.above_model ? "true" : "false")
+                << ",\n     \"points\": [";
+            for (size_t j = 0; j < r.bits.size(); ++j) {
+                out << (j ? ", " : "") << "{\"bits\": " << r.bits[j] << ", \"ns_per_op\": " << r.ns_per_op[j] << "}";
+            }
+            out << "],\n     \"tiers\": [";
+            for (size_t j = 0; j < r.tiers.size(); ++j) {
+                const ScalingTier& t = r.tiers[j];
+                out << (j ? ", " : "") << "{\"first_bits\": " << t.first_bits << ", \"last_bits\": " << t.last_bits
+                    << ", \"exponent\": " << t.exponent << "}";
+            }
+            out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"above_model\": " << above << "\n}\n";
+    } else {
+        out << std::left << std::setw(12) << "Kernel" << std::right << std::setw(10) << "model"
+            << std::setw(10) << "fit" << "   tiers (bits: exponent), crossovers" << "\n";
+        out << std::string(96, '-') << "\n" << std::fixed << std::setprecision(2);
+        for (const ScalingResult& r : results) {
+            out << std::left << std::setw(12) << r.kernel << std::right << std::setw(10) << r.model
+                << std::setw(10) << r.exponent << "   ";
+            for (size_t j = 0; j < r.tiers.size(); ++j) {
+                const ScalingTier& t = r.tiers[j];
+                if (j > 0) out << " | ~" << std::llround(std::sqrt(static_cast<double>(r.tiers[j - 1].last_bits) * t.first_bits)) << " | ";
+                out << t.first_bits << "-" << t.last_bits << ": " << t.exponent;
+            }
+            out << (r.above_model ? "   ABOVE MODEL" : "") << "\n";
+        }
+        out << above << " kernels above their model exponent\n";
+    }
+    return above == 0 ? 0 : 1;
+}
+
+// --- Steady-state allocation check ---
+
+static int run_alloc_check(size_t max_bits, std::ostream& out) {
+    std::mt19937_64 gen(20240917);
+    size_t failures = 0;
+    out << std::left << std::setw(32) << "Kernel" << std::right << std::setw(16) << "allocs/call" << std::setw(10) << "check" << "\n";
+    out << std::string(58, '-') << "\n" << std::fixed << std::setprecision(2);
+
+    // Runs op `calls` times after `warmup` calls and reports its allocations
+    auto check = [&](const std::string& name, size_t calls, size_t warmup, bool must_be_zero, const std::function<void()>& op) {
+        for (size_t i = 0; i < warmup; ++i) op();
+        uint64_t before = alloc_count.load();
+        for (size_t i = 0; i < calls; ++i) op();
+        uint64_t allocs = alloc_count.load() - before;
+        const char* verdict = !must_be_zero ? "info" : (allocs == 0 ? "pass" : "FAIL");
+        if (must_be_zero && allocs != 0) failures++;
+        out << std::left << std::setw(32) << name << std::right << std::setw(16)
+            << static_cast<double>(allocs) / calls << std::setw(10) << verdict << "\n";
+    };
+
+    for (size_t bits = 256; bits <= (max_bits ? max_bits : 2048); bits *= 2) {
+        std::string suffix = "/" + std::to_string(bits);
+        BigInt n = random_odd_bits(bits, gen), k = random_bits(bits, gen), x = random_bits(bits - 1, gen);
+
+        MontgomeryContext context(n);
+        LimbVector a(context.limbs()), b(context.limbs());
+        context.to_montgomery(x, a.data());
+        context.to_montgomery(k % n, b.data());
+        check("montgomery_mul" + suffix, 1000, 2, true, [&] { context.mul(a.data(), b.data(), a.data()); });
+
+        BigInt result;
+        check("montgomery_pow" + suffix, 3, 1, true, [&] { context.pow(x, k, result); });
+
+        MillerRabinTester tester(n);
+        check("miller_rabin_round" + suffix, 3, 1, true, [&] { do_not_optimize(tester.round()); });
+
+        // The value-returning API allocates its result and argument copies by design
+        check("powMod (by value)" + suffix, 3, 1, false, [&] { do_not_optimize(powMod(x, k, n)); });
+    }
+    out << failures << " kernels allocate in steady state\n";
+    return failures == 0 ? 0 : 1;
+}
+
+// --- End-to-end corpus replay ---
+
+struct CorpusResult {
+    std::string name;       // project/test_XX
+    size_t runs;
+    double p50_ns, p95_ns, p99_ns, mean_ns;
+    std::string status;     // pass, FAIL, or no-expected when the case has no .out file
+};
+
+static double percentile(const std::vector<double>& sorted, double q) {
+    size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+// Trailing whitespace and CRs differ between the committed .out files and our output
+static std::string trim_answer(std::string s) {
+    s.erase(std::remove(s.begin(), s.end(), '\r'), s.end());
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.pop_back();
+    return s;
+}
+
+static std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// A throwing solver counts as a wrong answer rather than ending the run
+static void solve_guarded(const Solver& solve, std::istream& in, std::ostream& out) {
+    try {
+        solve(in, out);
+    } catch (const std::exception& ex) {
+        out << "ERR " << ex.what();
+    }
+}
+
+static int run_corpus(const std::string& root, size_t repeat, const std::string& filter,
+                      const std::string& format, std::ostream& out) {
+    namespace fs = std::filesystem;
+    const std::map<std::string, Solver> projects = {
+        {"project_01_01", solve_isprime},
+        {"project_01_02", solve_inverse},
+        {"project_01_03", solve_powmod},
+    };
+
+    std::vector<CorpusResult> results;
+    std::map<std::string, std::pair<size_t, double>> per_project; // runs, total seconds
+    size_t failures = 0;
+    std::streambuf* saved_cerr = std::cerr.rdbuf();
+
+    for (const auto& project : projects) {
+        fs::path dir = fs::path(root) / project.first / "test";
+        if (!fs::is_directory(dir)) continue;
+        std::vector<fs::path> inputs;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().extension() == ".inp") inputs.push_back(entry.path());
+        }
+        std::sort(inputs.begin(), inputs.end());
+
+        for (const fs::path& input_path : inputs) {
+            std::string name = project.first + "/" + input_path.stem().string();
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+            std::string input = read_file(input_path);
+            fs::path expected_path = input_path;
+            expected_path.replace_extension(".out");
+            bool has_expected = fs::exists(expected_path);
+            std::string expected = has_expected ? trim_answer(read_file(expected_path)) : "";
+
+            std::vector<double> latencies;
+            latencies.reserve(repeat);
+            bool all_match = true;
+            std::cerr.rdbuf(nullptr); // The solvers' stderr notes would flood the report
+            for (size_t r = 0; r < repeat; ++r) {
+                std::istringstream in(input);
+                std::ostringstream answer;
+                auto start = std::chrono::steady_clock::now();
+                solve_guarded(project.second, in, answer);
+                latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+                if (has_expected && trim_answer(answer.str()) != expected) all_match = false;
+            }
+            std::cerr.rdbuf(saved_cerr);
+
+            std::sort(latencies.begin(), latencies.end());
+            double total = 0;
+            for (double ns : latencies) total += ns;
+
+            CorpusResult res;
+            res.name = name;
+            res.runs = repeat;
+            res.p50_ns = percentile(latencies, 0.50);
+            res.p95_ns = percentile(latencies, 0.95);
+            res.p99_ns = percentile(latencies, 0.99);
+            res.mean_ns = total / repeat;
+            res.status = !has_expected ? "no-expected" : (all_match ? "pass" : "FAIL");
+            if (res.status == "FAIL") failures++;
+            results.push_back(res);
+
+            per_project[project.first].first += repeat;
+            per_project[project.first].second += total / 1e9;
+            std::cerr << name << ": p50 " << res.p50_ns / 1000 << " us, " << res.status << std::endl;
+        }
+    }
+
+    if (format == "json") {
+        write_json_context(out);
+        out << "  \"cases\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const CorpusResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"runs\": " << r.runs
+                << ", \"p50_ns\": " << r.p50_ns << ", \"p95_ns\": " << r.p95_ns << ", \"p99_ns\": " << r.p99_ns
+                << ", \"mean_ns\": " << r.mean_ns << ", \"status\": \"" << r.status << "\"}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"projects\": [\n";
+        size_t i = 0;
+        for (const auto& p : per_project) {
+            out << "    {\"name\": \"" << p.first << "\", \"runs\": " << p.second.first
+                << ", \"seconds\": " << p.second.second
+                << ", \"cases_per_second\": " << p.second.first / p.second.second << "}"
+                << (++i < per_project.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"failures\": " << failures << "\n}\n";
+    } else {
+        out << std::left << std::setw(28) << "Case" << std::right << std::setw(14) << "p50 us"
+            << std::setw(14) << "p95 us" << std::setw(14) << "p99 us" << std::setw(14) << "mean us"
+            << std::setw(14) << "check" << "\n";
+        out << std::string(98, '-') << "\n" << std::fixed << std::setprecision(1);
+        for (const CorpusResult& r : results) {
+            out << std::left << std::setw(28) << r.name << std::right << std::setw(14) << r.p50_ns / 1000
+                << std::setw(14) << r.p95_ns / 1000 << std::setw(14) << r.p99_ns / 1000
+                << std::setw(14) << r.mean_ns / 1000 << std::setw(14) << r.status << "\n";
+        }
+        out << "\n" << std::setprecision(4);
+        for (const auto& p : per_project) {
+            out << p.first << ": " << p.second.first << " runs in " << p.second.second << " s, "
+                << p.second.first / p.second.second << " cases/s\n";
+        }
+        out << failures << " failing cases\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter, format = "console", out_path;
+    double min_time = 0.2;
+    size_t max_bits = 0; // 0: each kernel's default cap
+    std::string corpus_root;
+    size_t repeat = 10;
+    bool scaling = false;
+    bool use_perf = false;
+    bool alloc_check = false;
+    size_t steps_per_octave = 2;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--filter" && has_value) filter = argv[++i];
+        else if (arg == "--min-time" && has_value) min_time = std::atof(argv[++i]);
+        else if (arg == "--max-bits" && has_value) max_bits = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--format" && has_value) format = argv[++i];
+        else if (arg == "--out" && has_value) out_path = argv[++i];
+        else if (arg == "--corpus" && has_value) corpus_root = argv[++i];
+        else if (arg == "--repeat" && has_value) repeat = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--scaling") scaling = true;
+        else if (arg == "--perf") use_perf = true;
+        else if (arg == "--alloc-check") alloc_check = true;
+        else if (arg == "--steps-per-octave" && has_value) steps_per_octave = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--min-time <seconds>] [--max-bits <bits>]"
+                      << " [--perf] [--format console|json] [--out <file>]" << std::endl;
+            std::cerr << "       " << argv[0] << " --corpus <repo_root> [--repeat N] [--filter <substring>]"
+                      << " [--format console|json] [--out <file>]" << std::endl;
+            std::cerr << "       " << argv[0] << " --alloc-check [--max-bits <bits>] [--out <file>]" << std::endl;
+            std::cerr << "       " << argv[0] << " --scaling [--steps-per-octave N] [--filter <kernel>] [--min-time <seconds>]"
+                      << " [--max-bits <bits>] [--format console|json] [--out <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!out_path.empty()) {
+        file.open(out_path);
+        if (!file) {
+            std::cerr << "Cannot open file for writing: " << out_path << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = out_path.empty() ? std::cout : file;
+
+    if (!corpus_root.empty()) {
+        return run_corpus(corpus_root, repeat, filter, format, out);
+    }
+    if (alloc_check) {
+        return run_alloc_check(max_bits, out);
+    }
+    if (scaling) {
+        return run_scaling(filter, min_time, max_bits, steps_per_octave, format, out);
+    }
+
+    std::unique_ptr<PerfCounters> perf;
+    if (use_perf) {
+        perf.reset(new PerfCounters());
+        if (!perf->has_hardware()) {
+            std::cerr << "Hardware counters unavailable (" << perf->error() << "); reporting software events only" << std::endl;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    for (const BenchCase& c : make_cases()) {
+        size_t cap = max_bits ? max_bits : c.default_max_bits;
+        for (size_t bits = 64; bits <= 16384 && bits <= cap; bits *= 2) {
+            std::string name = c.kernel + "/" + std::to_string(bits);
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+            std::mt19937_64 gen = case_generator(c.kernel, bits); // The same operands on every run
+            std::function<void()> op = c.setup(bits, gen);
+            results.push_back(run_case(c.kernel, bits, op, min_time, perf.get()));
+            results.back().limb_ops = c.limb_ops(bits / 64.0);
+            std::cerr << name << ": " << results.back().ns_per_op << " ns/op" << std::endl;
+        }
+    }
+
+    if (format == "json") {
+        write_json(out, results);
+    } else {
+        write_console(out, results);
+        if (perf) write_console_perf(out, results);
+    }
+    return 0;
+}
@@ -4,11 +4,15 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>      // For uint64_t, uint32_t
 #include <stdexcept>    // For std::runtime_error
 #include <algorithm>    // For std::max, std::min
 #include <iomanip>      // For std::setw, std::setfill
+#include <cmath>        // For std::sqrt in isqrt
+#include "bigint_stats.h"
+#include "work_pool.h"
 
 // --- FOR 128-BIT ARITHMETIC ---
 #if defined(__GNUC__) || defined(__clang__)
@@ -40,6 +44,29 @@ struct uint128_t {
 };
 #endif
 
+// --- Multiplication thresholds ---
+// Operand sizes, in limbs, from which multiplication and squaring switch from
+// the schoolbook loops to Karatsuba. The crossovers depend on the machine: the
+// tune tool measures them and writes bigint_thresholds.h next to this file,
+// which overrides these defaults when present.
+#if defined(__has_include)
+#if __has_include("bigint_thresholds.h")
+#include "bigint_thresholds.h"
+#endif
+#endif
+#ifndef BIGINT_KARATSUBA_MUL_THRESHOLD
+#define BIGINT_KARATSUBA_MUL_THRESHOLD 32
+#endif
+#ifndef BIGINT_KARATSUBA_SQR_THRESHOLD
+#define BIGINT_KARATSUBA_SQR_THRESHOLD 48
+#endif
+// From this size (in limbs, 1024 = 65536 bits) the low and high Karatsuba
+// sub-products run as tasks on WorkPool::shared() while the calling thread
+// computes the middle one
+#ifndef BIGINT_PARALLEL_MUL_THRESHOLD
+#define BIGINT_PARALLEL_MUL_THRESHOLD 1024
+#endif
+
 /**
  * @brief The BigInt Class
  * Stores a signed integer as a vector of 64-bit "limbs" (magnitude) + a sign flag.
@@ -47,9 +74,14 @@ struct uint128_t {
  */
 class BigInt {
 public:
-    std::vector<uint64_t> limbs; // magnitude (always non-negative)
+    LimbVector limbs;             // magnitude (always non-negative)
     bool neg;                     // sign flag; false means non-negative, true means negative
 
+    // Runtime copies of the thresholds above, so tune can move them without a rebuild
+    static inline size_t karatsuba_mul_threshold = BIGINT_KARATSUBA_MUL_THRESHOLD;
+    static inline size_t karatsuba_sqr_threshold = BIGINT_KARATSUBA_SQR_THRESHOLD;
+    static inline size_t parallel_mul_threshold = BIGINT_PARALLEL_MUL_THRESHOLD;
+
     // --- Constructors ---
     BigInt() : neg(false) { limbs.push_back(0); }
     BigInt(int64_t v) : neg(v < 0) {
@@ -116,6 +148,48 @@ public:
         return oss.str();
     }
 
+    // Parses the little-endian digit format of the input files
+    // (least significant hex digit first) without building a reversed copy
+    static BigInt from_reversed_hex(std::string_view rev_hex) {
+        BigInt result;
+        if (rev_hex.empty()) return result;
+        result.limbs.assign((rev_hex.length() + 15) / 16, 0);
+
+        for (size_t i = 0; i < rev_hex.length(); ++i) {
+            char c = rev_hex[i];
+            uint64_t val;
+            if (c >= '0' && c <= '9') val = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                val = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                val = c - 'A' + 10;
+            else
+                throw std::runtime_error("Invalid hex character");
+
+            result.limbs[i / 16] |= val << ((i % 16) * 4);
+        }
+        result.normalize();
+        return result;
+    }
+
+    // Same digits as to_hex_string(), least significant first
+    std::string to_reversed_hex_string() const {
+        static const char digits[] = "0123456789ABCDEF";
+        std::string out;
+        out.reserve(limbs.size() * 16 + 1);
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            uint64_t limb = limbs[i];
+            bool top = (i + 1 == limbs.size());
+            for (int nib = 0; nib < 16; ++nib) {
+                if (top && limb == 0 && nib > 0) break; // No leading zeros on the top limb
+                out.push_back(digits[limb & 0xF]);
+                limb >>= 4;
+            }
+        }
+        if (neg) out.push_back('-');
+        return out;
+    }
+
     // --- Helper Functions ---
     static unsigned count_leading_zeros(uint64_t limb) {
     #if defined(_MSC_VER) && !defined(__clang__)
@@ -134,6 +208,16 @@ public:
         return ms * 64 + (64 - count_leading_zeros(v));
     }
 
+    // Remainder of the magnitude by a small modulus, one half-limb at a time
+    uint32_t mod_small(uint32_t m) const {
+        uint64_t rem = 0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            rem = ((rem << 32) | (limbs[i] >> 32)) % m;
+            rem = ((rem << 32) | (limbs[i] & 0xFFFFFFFFULL)) % m;
+        }
+        return static_cast<uint32_t>(rem);
+    }
+
     void normalize() {
         while (limbs.size() > 1 && limbs.back() == 0) limbs.pop_back(); //Trimming leading zero limbs
         if (limbs.size() == 1 && limbs[0] == 0) neg = false;
@@ -301,14 +385,12 @@ public:
             for (size_t i = 0; i < larger->limbs.size(); ++i) {
                 uint64_t li = (i < larger->limbs.size()) ? larger->limbs[i] : 0;
                 uint64_t si = (i < smaller->limbs.size()) ? smaller->limbs[i] : 0;
-                uint64_t sub = li;
-                if (sub < si + borrow) {
-                    sub = sub + (UINT64_MAX - si - borrow + 1);
-                    borrow = 1;
-                } else {
-                    sub = sub - si - borrow;
-                    borrow = 0;
-                }
+                // Two steps, so si = UINT64_MAX with a pending borrow still borrows
+                uint64_t sub = li - si;
+                uint64_t next_borrow = (li < si) ? 1 : 0;
+                next_borrow |= (sub < borrow) ? 1 : 0;
+                sub -= borrow;
+                borrow = next_borrow;
                 result.limbs[i] = sub;
             }
 
@@ -322,35 +404,230 @@ public:
         return a + (-b);
     }
 
-    friend BigInt operator*(const BigInt& a, const BigInt& b) {
-        if (a.is_zero() || b.is_zero()) return BigInt(0);
-        
-        BigInt result;
-        result.limbs.assign(a.limbs.size() + b.limbs.size(), 0);
+    // --- Limb kernels behind operator* ---
+    // They work on raw little-endian limb arrays; r never aliases an input.
+
+    // Returns the low limb of a * b + c + carry and leaves the high limb in carry
+    static uint64_t mul_add(uint64_t a, uint64_t b, uint64_t c, uint64_t& carry) {
+    #if defined(__GNUC__) || defined(__clang__)
+        __uint128_t product = (__uint128_t)a * b + c + carry;
+        carry = (uint64_t)(product >> 64);
+        return (uint64_t)product;
+    #else
+        uint128_t product = uint128_t::mul_u64(a, b);
+        product = uint128_t::add_u128_u64(product, c);
+        product = uint128_t::add_u128_u64(product, carry);
+        carry = product.hi;
+        return product.lo;
+    #endif
+    }
+
+    // Returns the low limb of a + b + carry and leaves the carry-out (0 or 1) in carry
+    static uint64_t add_carry(uint64_t a, uint64_t b, uint64_t& carry) {
+        uint64_t sum = a + carry;
+        uint64_t c1 = sum < a;
+        sum += b;
+        carry = c1 | (sum < b);
+        return sum;
+    }
+
+    // r[0..an) = a + b for an >= bn; returns the carry out
+    static uint64_t add_limbs(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < bn; ++i) r[i] = add_carry(a[i], b[i], carry);
+        for (size_t i = bn; i < an; ++i) r[i] = add_carry(a[i], 0, carry);
+        return carry;
+    }
 
-        for (size_t i = 0; i < a.limbs.size(); ++i) {
+    // r[0..rn) += b[0..bn) for rn >= bn; the sum must fit in rn limbs
+    static void add_in_place(uint64_t* r, size_t rn, const uint64_t* b, size_t bn) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < bn; ++i) r[i] = add_carry(r[i], b[i], carry);
+        for (size_t i = bn; carry && i < rn; ++i) r[i] = add_carry(r[i], 0, carry);
+    }
+
+    // r[0..rn) -= b[0..bn) for rn >= bn; the difference must not be negative
+    static void sub_in_place(uint64_t* r, size_t rn, const uint64_t* b, size_t bn) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < rn && (i < bn || borrow); ++i) {
+            uint64_t bi = i < bn ? b[i] : 0;
+            uint64_t diff = r[i] - bi;
+            uint64_t b1 = r[i] < bi;
+            r[i] = diff - borrow;
+            borrow = b1 | (diff < borrow);
+        }
+    }
+
+    // r[0..an+bn) = a * b, schoolbook
+    static void mul_basecase(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+        BIGINT_COUNT(STAT_LIMB_MULS, an * bn);
+        std::fill(r, r + an + bn, 0);
+        for (size_t i = 0; i < an; ++i) {
             uint64_t carry = 0;
-            for (size_t j = 0; j < b.limbs.size(); ++j) {
-                #if defined(__GNUC__) || defined(__clang__)
-                // GCC/Clang path using native 128-bit type
-                __uint128_t product = (__uint128_t)a.limbs[i] * b.limbs[j] + 
-                                      result.limbs[i + j] + carry;
-                
-                result.limbs[i + j] = (uint64_t)product;
-                carry = (uint64_t)(product >> 64);
-                #else
-                // MSVC path using the struct and static helpers
-                uint128_t product = uint128_t::mul_u64(a.limbs[i], b.limbs[j]);
-                product = uint128_t::add_u128_u64(product, result.limbs[i + j]);
-                product = uint128_t::add_u128_u64(product, carry);
-
-                result.limbs[i + j] = product.lo;
-                carry = product.hi;
-                #endif
+            for (size_t j = 0; j < bn; ++j) {
+                r[i + j] = mul_add(a[i], b[j], r[i + j], carry);
             }
-            if (carry > 0) {
-                result.limbs[i + b.limbs.size()] += carry;
+            r[i + bn] = carry;
+        }
+    }
+
+    // r[0..2n) = a^2, schoolbook: each cross product once, doubled, plus the squares
+    static void sqr_basecase(uint64_t* r, const uint64_t* a, size_t n) {
+        BIGINT_COUNT(STAT_LIMB_MULS, n * (n + 1) / 2);
+        std::fill(r, r + 2 * n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t carry = 0;
+            for (size_t j = i + 1; j < n; ++j) {
+                r[i + j] = mul_add(a[i], a[j], r[i + j], carry);
             }
+            r[i + n] = carry;
+        }
+        uint64_t top = 0;
+        for (size_t i = 0; i < 2 * n; ++i) {
+            uint64_t next = r[i] >> 63;
+            r[i] = (r[i] << 1) | top;
+            top = next;
+        }
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t hi = 0;
+            uint64_t lo = mul_add(a[i], a[i], 0, hi);
+            r[2 * i] = add_carry(r[2 * i], lo, carry);
+            r[2 * i + 1] = add_carry(r[2 * i + 1], hi, carry);
+        }
+    }
+
+    // Scratch limbs mul_n / sqr_n need for n-limb operands
+    static size_t karatsuba_scratch(size_t n, size_t threshold) {
+        size_t total = 0;
+        while (n >= threshold && n >= 4) {
+            size_t h = n - n / 2;
+            total += 4 * (h + 1);
+            n = h + 1;
+        }
+        return total;
+    }
+
+    // r[0..2n) = a * b for two n-limb operands (Karatsuba above the threshold).
+    // With a = a1 B^m + a0: a * b = z2 B^2m + (z1 - z2 - z0) B^m + z0, where
+    // z1 = (a0 + a1)(b0 + b1) costs one multiplication instead of two.
+    static void mul_n(uint64_t* r, const uint64_t* a, const uint64_t* b, size_t n, uint64_t* scratch) {
+        if (n < karatsuba_mul_threshold || n < 4) {
+            mul_basecase(r, a, n, b, n);
+            return;
+        }
+        size_t m = n / 2, h = n - m;
+        uint64_t* sa = scratch;
+        uint64_t* sb = sa + h + 1;
+        uint64_t* z1 = sb + h + 1;
+        uint64_t* next = z1 + 2 * (h + 1);
+
+        sa[h] = add_limbs(sa, a + m, h, a, m);
+        sb[h] = add_limbs(sb, b + m, h, b, m);
+        if (n >= parallel_mul_threshold) {
+            // z0 and z2 are forked with scratch of their own; z1 stays on this thread
+            TaskGroup group;
+            group.run([=] {
+                LimbVector own(karatsuba_scratch(m, karatsuba_mul_threshold));
+                mul_n(r, a, b, m, own.data());
+            });
+            group.run([=] {
+                LimbVector own(karatsuba_scratch(h, karatsuba_mul_threshold));
+                mul_n(r + 2 * m, a + m, b + m, h, own.data());
+            });
+            mul_n(z1, sa, sb, h + 1, next);
+            group.wait();
+        } else {
+            mul_n(r, a, b, m, next);                  // z0
+            mul_n(r + 2 * m, a + m, b + m, h, next);  // z2
+            mul_n(z1, sa, sb, h + 1, next);
+        }
+        sub_in_place(z1, 2 * h + 2, r, 2 * m);
+        sub_in_place(z1, 2 * h + 2, r + 2 * m, 2 * h);
+        add_in_place(r + m, 2 * n - m, z1, std::min(2 * h + 2, 2 * n - m));
+    }
+
+    // r[0..2n) = a^2, the same split with one operand
+    static void sqr_n(uint64_t* r, const uint64_t* a, size_t n, uint64_t* scratch) {
+        if (n < karatsuba_sqr_threshold || n < 4) {
+            sqr_basecase(r, a, n);
+            return;
+        }
+        size_t m = n / 2, h = n - m;
+        uint64_t* sa = scratch;
+        uint64_t* z1 = sa + h + 1;
+        uint64_t* next = z1 + 2 * (h + 1);
+
+        sa[h] = add_limbs(sa, a + m, h, a, m);
+        if (n >= parallel_mul_threshold) {
+            TaskGroup group;
+            group.run([=] {
+                LimbVector own(karatsuba_scratch(m, karatsuba_sqr_threshold));
+                sqr_n(r, a, m, own.data());
+            });
+            group.run([=] {
+                LimbVector own(karatsuba_scratch(h, karatsuba_sqr_threshold));
+                sqr_n(r + 2 * m, a + m, h, own.data());
+            });
+            sqr_n(z1, sa, h + 1, next);
+            group.wait();
+        } else {
+            sqr_n(r, a, m, next);
+            sqr_n(r + 2 * m, a + m, h, next);
+            sqr_n(z1, sa, h + 1, next);
+        }
+        sub_in_place(z1, 2 * h + 2, r, 2 * m);
+        sub_in_place(z1, 2 * h + 2, r + 2 * m, 2 * h);
+        add_in_place(r + m, 2 * n - m, z1, std::min(2 * h + 2, 2 * n - m));
+    }
+
+    // r[0..an+bn) = a * b for any sizes. Unbalanced products are cut into
+    // slices of the shorter operand's size so each piece is balanced.
+    static void mul_limbs(uint64_t* r, const uint64_t* a, size_t an, const uint64_t* b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        if (bn < karatsuba_mul_threshold) {
+            mul_basecase(r, a, an, b, bn);
+            return;
+        }
+        size_t scratch_limbs = karatsuba_scratch(bn, karatsuba_mul_threshold);
+        if (an == bn) {
+            LimbVector scratch(scratch_limbs);
+            mul_n(r, a, b, bn, scratch.data());
+            return;
+        }
+        LimbVector scratch(2 * bn + scratch_limbs);
+        uint64_t* part = scratch.data();
+        std::fill(r, r + an + bn, 0);
+        for (size_t off = 0; off < an; off += bn) {
+            size_t len = std::min(bn, an - off);
+            if (len == bn) mul_n(part, a + off, b, bn, part + 2 * bn);
+            else mul_limbs(part, b, bn, a + off, len);
+            add_in_place(r + off, an + bn - off, part, len + bn);
+        }
+    }
+
+    // r[0..2n) = a^2
+    static void sqr_limbs(uint64_t* r, const uint64_t* a, size_t n) {
+        if (n < karatsuba_sqr_threshold) {
+            sqr_basecase(r, a, n);
+            return;
+        }
+        LimbVector scratch(karatsuba_scratch(n, karatsuba_sqr_threshold));
+        sqr_n(r, a, n, scratch.data());
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b) {
+        if (a.is_zero() || b.is_zero()) return BigInt(0);
+
+        BigInt result;
+        result.limbs.assign(a.limbs.size() + b.limbs.size(), 0);
+        if (&a == &b) {
+            sqr_limbs(result.limbs.data(), a.limbs.data(), a.limbs.size()); // x * x, as in powMod
+        } else {
+            mul_limbs(result.limbs.data(), a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size());
         }
         result.neg = (a.neg != b.neg) && !result.is_zero();
         result.normalize();
@@ -361,6 +638,7 @@ public:
         if (divisor_in.is_zero()) {
             throw std::invalid_argument("Division by zero");
         }
+        BIGINT_COUNT(STAT_DIVISIONS, 1);
 
         // Special-case small dividend < divisor: quotient = 0, remainder = dividend (keep sign)
         BigInt u = dividend_in.abs();
@@ -404,6 +682,28 @@ public:
         return {quotient, remainder};
     }
 
+    // Integer square root: the largest r with r * r <= n (Newton iteration)
+    static BigInt isqrt(const BigInt& n) {
+        if (n.neg) {
+            throw std::invalid_argument("Square root of negative number");
+        }
+        if (n.is_zero()) return BigInt(0);
+
+        // Start above the root so the iteration decreases monotonically: the
+        // square root of the leading 64 bits (an even shift down) is good to
+        // about 30 bits, so only a few Newton steps remain
+        size_t bits = n.bit_length();
+        size_t shift = bits > 64 ? (bits - 63) & ~size_t(1) : 0;
+        uint64_t top = (n >> shift).limbs[0];
+        BigInt x = BigInt(static_cast<int64_t>(std::sqrt(static_cast<double>(top))) + 2) << (shift / 2);
+        while (true) {
+            BigInt y = (x + n / x) >> 1;
+            if (!(y < x)) break;
+            x = y;
+        }
+        return x;
+    }
+
     friend BigInt operator/(const BigInt& a, const BigInt& b) {
         return divmod(a, b).first;
     }
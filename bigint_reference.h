@@ -0,0 +1,185 @@
+#ifndef BIGINT_REFERENCE_H
+#define BIGINT_REFERENCE_H
+
+// Frozen reference arithmetic for differential testing. These are the plain
+// limb loops BigInt started from: schoolbook multiplication, bit-serial long
+// division and square-and-multiply. They are slow on purpose and must not be
+// optimized or rewritten on top of BigInt's operators; every fast path is
+// checked against them (see verify/main.cpp).
+
+#include "bigInt.h"
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+using RefLimbs = std::vector<uint64_t>;
+
+static void ref_trim(RefLimbs& a) {
+    while (a.size() > 1 && a.back() == 0) a.pop_back();
+    if (a.empty()) a.push_back(0);
+}
+
+static bool ref_is_zero(const RefLimbs& a) {
+    return a.size() == 1 && a[0] == 0;
+}
+
+// -1, 0 or 1 as |a| is below, equal to or above |b|; both trimmed
+static int ref_compare(const RefLimbs& a, const RefLimbs& b) {
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+static RefLimbs ref_add_magnitude(const RefLimbs& a, const RefLimbs& b) {
+    size_t n = std::max(a.size(), b.size());
+    RefLimbs r(n + 1, 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned __int128 sum = (unsigned __int128)(i < a.size() ? a[i] : 0) + (i < b.size() ? b[i] : 0) + carry;
+        r[i] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+    r[n] = carry;
+    ref_trim(r);
+    return r;
+}
+
+// |a| - |b| for |a| >= |b|
+static RefLimbs ref_sub_magnitude(const RefLimbs& a, const RefLimbs& b) {
+    RefLimbs r(a.size(), 0);
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        unsigned __int128 sub = (unsigned __int128)(i < b.size() ? b[i] : 0) + borrow;
+        r[i] = (uint64_t)((unsigned __int128)a[i] - sub);
+        borrow = (unsigned __int128)a[i] < sub ? 1 : 0;
+    }
+    ref_trim(r);
+    return r;
+}
+
+static BigInt ref_make(const RefLimbs& mag, bool neg) {
+    BigInt r;
+    r.limbs.assign(mag.begin(), mag.end());
+    r.neg = neg;
+    r.normalize();
+    return r;
+}
+
+static RefLimbs ref_magnitude(const BigInt& a) {
+    RefLimbs m(a.limbs.begin(), a.limbs.end());
+    ref_trim(m);
+    return m;
+}
+
+/**
+ * @brief Signed a + b.
+ */
+BigInt reference_add(const BigInt& a, const BigInt& b) {
+    RefLimbs x = ref_magnitude(a), y = ref_magnitude(b);
+    if (a.neg == b.neg) return ref_make(ref_add_magnitude(x, y), a.neg);
+    if (ref_compare(x, y) >= 0) return ref_make(ref_sub_magnitude(x, y), a.neg);
+    return ref_make(ref_sub_magnitude(y, x), b.neg);
+}
+
+/**
+ * @brief Signed a - b.
+ */
+BigInt reference_sub(const BigInt& a, const BigInt& b) {
+    BigInt nb = b;
+    if (!nb.is_zero()) nb.neg = !nb.neg;
+    return reference_add(a, nb);
+}
+
+/**
+ * @brief Signed a * b, schoolbook.
+ */
+BigInt reference_mul(const BigInt& a, const BigInt& b) {
+    RefLimbs x = ref_magnitude(a), y = ref_magnitude(b);
+    RefLimbs r(x.size() + y.size(), 0);
+    for (size_t i = 0; i < x.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < y.size(); ++j) {
+            unsigned __int128 product = (unsigned __int128)x[i] * y[j] + r[i + j] + carry;
+            r[i + j] = (uint64_t)product;
+            carry = (uint64_t)(product >> 64);
+        }
+        r[i + y.size()] = carry;
+    }
+    ref_trim(r);
+    return ref_make(r, a.neg != b.neg);
+}
+
+/**
+ * @brief |a| << bits with a's sign.
+ */
+BigInt reference_shl(const BigInt& a, size_t bits) {
+    RefLimbs x = ref_magnitude(a);
+    RefLimbs r(x.size() + bits / 64 + 1, 0);
+    for (size_t i = 0; i < x.size() * 64; ++i) {
+        if ((x[i / 64] >> (i % 64)) & 1) r[(i + bits) / 64] |= uint64_t(1) << ((i + bits) % 64);
+    }
+    ref_trim(r);
+    return ref_make(r, a.neg);
+}
+
+/**
+ * @brief |a| >> bits with a's sign (the magnitude is truncated).
+ */
+BigInt reference_shr(const BigInt& a, size_t bits) {
+    RefLimbs x = ref_magnitude(a);
+    RefLimbs r(x.size(), 0);
+    for (size_t i = bits; i < x.size() * 64; ++i) {
+        if ((x[i / 64] >> (i % 64)) & 1) r[(i - bits) / 64] |= uint64_t(1) << ((i - bits) % 64);
+    }
+    ref_trim(r);
+    return ref_make(r, a.neg);
+}
+
+/**
+ * @brief Truncated division: the quotient rounds toward zero and the
+ * remainder takes the dividend's sign. One quotient bit per step.
+ */
+std::pair<BigInt, BigInt> reference_divmod(const BigInt& a, const BigInt& b) {
+    RefLimbs u = ref_magnitude(a), v = ref_magnitude(b);
+    if (ref_is_zero(v)) {
+        throw std::invalid_argument("Division by zero");
+    }
+    RefLimbs q(u.size(), 0), r(1, 0);
+    for (size_t i = u.size() * 64; i-- > 0;) {
+        // r = 2r + bit i of u
+        uint64_t carry = (u[i / 64] >> (i % 64)) & 1;
+        for (size_t j = 0; j < r.size(); ++j) {
+            uint64_t next = r[j] >> 63;
+            r[j] = (r[j] << 1) | carry;
+            carry = next;
+        }
+        if (carry) r.push_back(carry);
+        if (ref_compare(r, v) >= 0) {
+            r = ref_sub_magnitude(r, v);
+            q[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+    ref_trim(q);
+    return {ref_make(q, a.neg != b.neg), ref_make(r, a.neg)};
+}
+
+/**
+ * @brief base^exp mod m for m > 0 and exp >= 0, left-to-right square and
+ * multiply; the result lies in [0, m).
+ */
+BigInt reference_powmod(const BigInt& base, const BigInt& exp, const BigInt& m) {
+    BigInt b = reference_divmod(base, m).second;
+    if (b.neg) b = reference_add(b, m);
+    BigInt result = reference_divmod(BigInt(1), m).second;
+    for (size_t i = exp.bit_length(); i-- > 0;) {
+        result = reference_divmod(reference_mul(result, result), m).second;
+        if ((exp.limbs[i / 64] >> (i % 64)) & 1) {
+            result = reference_divmod(reference_mul(result, b), m).second;
+        }
+    }
+    return result;
+}
+
+#endif // BIGINT_REFERENCE_H
@@ -0,0 +1,188 @@
+#ifndef BIGINT_STATS_H
+#define BIGINT_STATS_H
+
+// Operation counters for capacity planning and per-request costing. Built with
+// -DBIGINT_STATS, the BigInt kernels and Miller-Rabin count their work into a
+// per-thread block, and bigint_stats_total() sums every block on demand.
+// Without it BIGINT_COUNT expands to nothing and LimbVector is a plain
+// std::vector, so a normal build pays nothing.
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+
+#if defined(BIGINT_STATS)
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#endif
+
+enum BigIntStat {
+    STAT_LIMB_MULS,         // 64x64-bit multiplies in the multiplication kernels
+    STAT_DIVISIONS,         // divmod calls
+    STAT_ALLOCATIONS,       // limb buffer allocations
+    STAT_BYTES_ALLOCATED,
+    STAT_MODEXPS,           // modular exponentiations: powMod calls and Miller-Rabin rounds
+    STAT_MR_ROUNDS,         // Miller-Rabin witness rounds
+    STAT_MR_EARLY_EXITS,    // Miller-Rabin calls that returned composite before the last round
+    STAT_COUNT
+};
+
+static const char* const bigint_stat_names[STAT_COUNT] = {
+    "limb_muls", "divisions", "allocations", "bytes_allocated", "modexps", "mr_rounds", "mr_early_exits",
+};
+
+/**
+ * @brief A snapshot of the counters, summed over threads or taken from one thread.
+ */
+struct BigIntStats {
+    uint64_t values[STAT_COUNT] = {};
+
+    BigIntStats operator-(const BigIntStats& o) const {
+        BigIntStats d;
+        for (size_t i = 0; i < STAT_COUNT; ++i) d.values[i] = values[i] - o.values[i];
+        return d;
+    }
+};
+
+#if defined(BIGINT_STATS)
+
+/**
+ * @brief One thread's counters. Only the owning thread writes them, so a
+ * relaxed load and store is enough and no locked instruction is needed.
+ */
+struct StatsBlock {
+    std::atomic<uint64_t> counters[STAT_COUNT] = {};
+
+    StatsBlock();
+    ~StatsBlock();
+};
+
+struct StatsRegistry {
+    std::mutex mutex;
+    std::vector<StatsBlock*> live;
+    uint64_t retired[STAT_COUNT] = {};  // counts of threads that have exited
+};
+
+StatsRegistry& stats_registry() {
+    static StatsRegistry registry;
+    return registry;
+}
+
+StatsBlock::StatsBlock() {
+    StatsRegistry& registry = stats_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.live.push_back(this);
+}
+
+StatsBlock::~StatsBlock() {
+    StatsRegistry& registry = stats_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t i = 0; i < STAT_COUNT; ++i) registry.retired[i] += counters[i].load(std::memory_order_relaxed);
+    registry.live.erase(std::find(registry.live.begin(), registry.live.end(), this));
+}
+
+StatsBlock& thread_stats_block() {
+    static thread_local StatsBlock block;
+    return block;
+}
+
+void bigint_stats_add(BigIntStat stat, uint64_t n) {
+    std::atomic<uint64_t>& counter = thread_stats_block().counters[stat];
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#define BIGINT_COUNT(stat, n) bigint_stats_add((stat), (n))
+
+/**
+ * @brief Counts limb buffer allocations; BigInt stores its limbs with it.
+ */
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        bigint_stats_add(STAT_ALLOCATIONS, 1);
+        bigint_stats_add(STAT_BYTES_ALLOCATED, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+using LimbVector = std::vector<uint64_t, CountingAllocator<uint64_t>>;
+
+#else
+
+#define BIGINT_COUNT(stat, n) ((void)0)
+
+using LimbVector = std::vector<uint64_t>;
+
+#endif
+
+/**
+ * @brief Whether this build counts anything.
+ */
+bool bigint_stats_enabled() {
+#if defined(BIGINT_STATS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief The calling thread's counters, e.g. to cost one request as the
+ * difference of two snapshots around it.
+ */
+BigIntStats bigint_stats_thread() {
+    BigIntStats stats;
+#if defined(BIGINT_STATS)
+    StatsBlock& block = thread_stats_block();
+    for (size_t i = 0; i < STAT_COUNT; ++i) stats.values[i] = block.counters[i].load(std::memory_order_relaxed);
+#endif
+    return stats;
+}
+
+/**
+ * @brief The counters of every thread so far, including threads that have exited.
+ */
+BigIntStats bigint_stats_total() {
+    BigIntStats stats;
+#if defined(BIGINT_STATS)
+    StatsRegistry& registry = stats_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t i = 0; i < STAT_COUNT; ++i) stats.values[i] = registry.retired[i];
+    for (StatsBlock* block : registry.live) {
+        for (size_t i = 0; i < STAT_COUNT; ++i) stats.values[i] += block->counters[i].load(std::memory_order_relaxed);
+    }
+#endif
+    return stats;
+}
+
+/**
+ * @brief The counters as one JSON object.
+ */
+std::string bigint_stats_json(const BigIntStats& stats) {
+    std::string json = "{\"enabled\": ";
+    json += bigint_stats_enabled() ? "true" : "false";
+    for (size_t i = 0; i < STAT_COUNT; ++i) {
+        json += ", \"";
+        json += bigint_stat_names[i];
+        json += "\": " + std::to_string(stats.values[i]);
+    }
+    json += "}";
+    return json;
+}
+
+#endif // BIGINT_STATS_H
@@ -0,0 +1,798 @@
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>      // For std::pair
+#include <functional>   // For std::function
+#include <filesystem>   // For directory scans in batch mode
+#include <algorithm>    // For std::sort
+#include <tuple>
+#include <stdexcept>    // For std::exception
+#include "bigInt.h"
+#include "mapped_input.h"
+#include "uring_batch.h"
+#include "latency_histogram.h"
+#include "trace.h"
+#include "job_scheduler.h"
+#include <thread>       // For std::thread::hardware_concurrency
+#include <map>
+#include <chrono>
+#include <iterator>     // For std::istreambuf_iterator
+#include <cstdlib>      // For std::atof
+#include <memory>       // For std::unique_ptr
+
+#if defined(__cpp_impl_coroutine)
+#include "pipeline.h"
+#endif
+
+/**
+ * @brief A solver reads one request from `in` and writes its answer to `out`.
+ */
+using Solver = std::function<void(std::istream&, std::ostream&)>;
+
+/**
+ * @brief The compute step of an operation on already-parsed values: it takes
+ * the request values and leaves the answer values in their place. Leaving no
+ * values means the request has no answer, written as -1.
+ */
+using ComputeStep = void (*)(std::vector<BigInt>& values);
+
+/**
+ * @brief The token count of one request and the step that computes its answer.
+ * Splitting parse, compute and format lets bulk mode skip the iostreams and
+ * lets the pipeline run each step as its own stage.
+ * A count of 0 means the operation has no bulk mode.
+ * The name labels the operation in latency reports.
+ * Requests that agree on the modulus field share one Montgomery context, and
+ * those that also agree on the base field share its window table, so bulk mode
+ * runs them back to back; -1 means the operation has no such field.
+ */
+struct FieldOp {
+    size_t count;
+    ComputeStep compute;
+    const char* name = nullptr;
+    int modulus_field = -1;
+    int base_field = -1;
+};
+
+/**
+ * @brief Parses reversed-hex request tokens into values.
+ */
+void parse_fields(const std::string_view* fields, size_t count, std::vector<BigInt>& values) {
+    values.clear();
+    for (size_t i = 0; i < count; ++i) {
+        values.push_back(BigInt::from_reversed_hex(fields[i]));
+    }
+}
+
+/**
+ * @brief Appends one answer line: the values in reversed hex, or -1 when there are none.
+ */
+void format_results(const std::vector<BigInt>& values, std::string& out) {
+    if (values.empty()) {
+        out += "-1\n";
+        return;
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) out += ' ';
+        out += values[i].to_reversed_hex_string();
+    }
+    out += '\n';
+}
+
+/**
+ * @brief Answers one request from its split tokens and appends the answer line.
+ */
+void solve_fields(const std::string_view* fields, const FieldOp& op, std::string& out) {
+    std::vector<BigInt> values;
+    parse_fields(fields, op.count, values);
+    op.compute(values);
+    format_results(values, out);
+}
+
+/**
+ * @brief Answers a block of requests (op.count fields each) and appends the
+ * answer lines in input order. When op has a modulus field the requests run
+ * grouped by the hashes of their modulus and base tokens, so every group sets
+ * up its context and window table once. A request that fails answers "ERR <reason>".
+ */
+void solve_block(const std::vector<std::string_view>& fields, const FieldOp& op, std::string& out) {
+    size_t requests = fields.size() / op.count;
+    auto solve_one = [&](size_t r, std::string& answer) {
+        try {
+            solve_fields(&fields[r * op.count], op, answer);
+        } catch (const std::exception& ex) {
+            answer += "ERR ";
+            answer += ex.what();
+            answer += '\n';
+        }
+    };
+    if (op.modulus_field < 0 || requests < 2) {
+        for (size_t r = 0; r < requests; ++r) solve_one(r, out);
+        return;
+    }
+
+    // (modulus hash, base hash, index): equal keys stay in input order
+    std::vector<std::tuple<uint64_t, uint64_t, size_t>> order;
+    order.reserve(requests);
+    for (size_t r = 0; r < requests; ++r) {
+        const std::string_view* request = &fields[r * op.count];
+        order.emplace_back(fnv1a_hash(request[op.modulus_field]),
+                           op.base_field >= 0 ? fnv1a_hash(request[op.base_field]) : 0, r);
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<std::string> answers(requests);
+    for (const auto& entry : order) solve_one(std::get<2>(entry), answers[std::get<2>(entry)]);
+    for (const auto& answer : answers) out += answer;
+}
+
+/**
+ * @brief Reads `count` whitespace-separated tokens from `in` into tokens and
+ * fields. Throws when the input ends first, so a short request is rejected
+ * instead of being parsed as zeros.
+ */
+void read_fields(std::istream& in, size_t count, std::string* tokens, std::string_view* fields) {
+    for (size_t i = 0; i < count; ++i) {
+        if (!(in >> tokens[i])) {
+            throw std::runtime_error("Expected " + std::to_string(count) + " fields, got " + std::to_string(i));
+        }
+        fields[i] = tokens[i];
+    }
+}
+
+/**
+ * @brief Reads op.count tokens from `in` and answers them with op.compute.
+ */
+void solve_with_fields(std::istream& in, std::ostream& out, const FieldOp& op) {
+    std::string tokens[8];
+    std::string_view fields[8];
+    read_fields(in, op.count, tokens, fields);
+    std::string answer;
+    solve_fields(fields, op, answer);
+    out << answer;
+}
+
+/**
+ * @brief Answers one request like `solve`, recording the parse, compute and
+ * format stages separately when op splits them (otherwise the whole solve is
+ * compute). Returns the largest operand size in bits, 0 when unknown, so the
+ * caller files its read and write samples under the same size class.
+ */
+size_t solve_timed(std::istream& in, std::ostream& out, const Solver& solve, const FieldOp& op, StageLatencies& latencies) {
+    using clock = std::chrono::steady_clock;
+    std::string name = op.name ? op.name : "request";
+
+    if (op.count == 0) {
+        auto start = clock::now();
+        solve(in, out);
+        latencies.record(STAGE_COMPUTE, name, 0, clock::now() - start);
+        return 0;
+    }
+
+    auto start = clock::now();
+    std::string tokens[8];
+    std::string_view fields[8];
+    read_fields(in, op.count, tokens, fields);
+    std::vector<BigInt> values;
+    parse_fields(fields, op.count, values);
+    size_t bits = 0;
+    for (const BigInt& v : values) bits = std::max(bits, v.bit_length());
+    auto parsed = clock::now();
+    op.compute(values);
+    auto computed = clock::now();
+    std::string answer;
+    format_results(values, answer);
+    out << answer;
+    auto formatted = clock::now();
+
+    latencies.record(STAGE_PARSE, name, bits, parsed - start);
+    latencies.record(STAGE_COMPUTE, name, bits, computed - parsed);
+    latencies.record(STAGE_FORMAT, name, bits, formatted - computed);
+    return bits;
+}
+
+/**
+ * @brief Runs the solver on one input file and writes one output file.
+ */
+int run_single(const std::string& input_filename, const std::string& output_filename, const Solver& solve) {
+    std::ifstream file(input_filename);
+    if (!file) {
+        std::cerr << "Cannot read file: " << input_filename << std::endl;
+        return 1;
+    }
+
+    std::ofstream outfile(output_filename);
+    if (!outfile) {
+        std::cerr << "Cannot open file for writing: " << output_filename << std::endl;
+        return 1;
+    }
+
+    try {
+        solve(file, outfile);
+    } catch (const std::exception& ex) {
+        std::cerr << input_filename << ": " << ex.what() << std::endl;
+        return 1;
+    }
+    file.close();
+    outfile.close();
+    return 0;
+}
+
+/**
+ * @brief run_single with every stage timed: the whole file is read first so
+ * reading, solving and writing can be told apart.
+ */
+int run_single_timed(const std::string& input_filename, const std::string& output_filename,
+                     const Solver& solve, const FieldOp& op, StageLatencies& latencies) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    std::ifstream file(input_filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot read file: " << input_filename << std::endl;
+        return 1;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    auto read = clock::now();
+
+    std::istringstream in(content);
+    std::ostringstream answer;
+    size_t bits;
+    try {
+        bits = solve_timed(in, answer, solve, op, latencies);
+    } catch (const std::exception& ex) {
+        std::cerr << input_filename << ": " << ex.what() << std::endl;
+        return 1;
+    }
+
+    auto write_start = clock::now();
+    std::ofstream outfile(output_filename);
+    if (!outfile) {
+        std::cerr << "Cannot open file for writing: " << output_filename << std::endl;
+        return 1;
+    }
+    outfile << answer.str();
+    outfile.close();
+
+    std::string name = op.name ? op.name : "request";
+    latencies.record(STAGE_READ, name, bits, read - start);
+    latencies.record(STAGE_WRITE, name, bits, clock::now() - write_start);
+    return 0;
+}
+
+/**
+ * @brief Collects (input, output) pairs for batch mode.
+ * A directory yields every *.inp in it, each paired with the same name ending in .out.
+ * Any other path is read as a manifest: one "<input_file> [output_file]" per line.
+ * When output_dir is not empty, the .out files are placed there instead.
+ */
+std::vector<std::pair<std::string, std::string>> collect_batch_jobs(const std::string& target, const std::string& output_dir) {
+    namespace fs = std::filesystem;
+    std::vector<std::pair<std::string, std::string>> jobs;
+
+    auto output_for = [&](const fs::path& input) {
+        fs::path out = input;
+        out.replace_extension(".out");
+        if (!output_dir.empty()) out = fs::path(output_dir) / out.filename();
+        return out.string();
+    };
+
+    if (fs::is_directory(target)) {
+        for (const auto& entry : fs::directory_iterator(target)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".inp") {
+                jobs.emplace_back(entry.path().string(), output_for(entry.path()));
+            }
+        }
+        std::sort(jobs.begin(), jobs.end());
+        return jobs;
+    }
+
+    std::ifstream manifest(target);
+    if (!manifest) {
+        throw std::runtime_error("Cannot read batch directory or manifest: " + target);
+    }
+    std::string line;
+    while (std::getline(manifest, line)) {
+        std::istringstream fields(line);
+        std::string input, output;
+        if (!(fields >> input) || input[0] == '#') continue;
+        if (!(fields >> output)) output = output_for(input);
+        jobs.emplace_back(input, output);
+    }
+    return jobs;
+}
+
+/**
+ * @brief Estimated cost of every batch job from the size of its input file, for the lane scheduler.
+ */
+std::vector<double> batch_job_costs(const std::vector<std::pair<std::string, std::string>>& jobs, const FieldOp& op) {
+    std::string name = op.name ? op.name : "";
+    std::vector<double> costs;
+    costs.reserve(jobs.size());
+    for (const auto& job : jobs) costs.push_back(estimate_file_cost(name, job.first));
+    return costs;
+}
+
+/**
+ * @brief Runs the solver over every job of a batch inside this one process.
+ * Jobs run in the order of the lane scheduler, so small files are not stuck
+ * behind large ones. A failing job is reported and skipped; the others still
+ * run. With latencies set, every job's stages are timed into them.
+ */
+int run_batch(const std::string& target, const std::string& output_dir, const Solver& solve,
+              const FieldOp& op = {0, nullptr}, StageLatencies* latencies = nullptr,
+              const SchedulerConfig& schedule = SchedulerConfig()) {
+    std::vector<std::pair<std::string, std::string>> jobs;
+    try {
+        jobs = collect_batch_jobs(target, output_dir);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<double> costs = batch_job_costs(jobs, op);
+    LaneScheduler<size_t> order(schedule);
+    for (size_t j = 0; j < jobs.size(); ++j) order.push(j, costs[j]);
+
+    size_t failed = 0;
+    size_t next;
+    while (order.pop(next)) {
+        const auto& job = jobs[next];
+        try {
+            int status = latencies ? run_single_timed(job.first, job.second, solve, op, *latencies)
+                                   : run_single(job.first, job.second, solve);
+            if (status != 0) failed++;
+        } catch (const std::exception& ex) {
+            std::cerr << job.first << ": " << ex.what() << std::endl;
+            failed++;
+        }
+    }
+
+    std::cerr << "Processed " << jobs.size() << " files, " << failed << " failed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Batch mode with file I/O overlapped with compute: io_uring keeps a
+ * bounded window of files being opened, read and written while one solver
+ * thread per core works through the files already read. Files enter the
+ * window in the order of the lane scheduler.
+ */
+int run_batch_async(const std::string& target, const std::string& output_dir, const Solver& solve,
+                    const FieldOp& op = {0, nullptr}, const SchedulerConfig& schedule = SchedulerConfig()) {
+    std::vector<std::pair<std::string, std::string>> jobs;
+    try {
+        jobs = collect_batch_jobs(target, output_dir);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_in_flight = std::max<size_t>(16, 4 * workers);
+    std::vector<double> costs = batch_job_costs(jobs, op);
+    size_t failed = run_batch_uring(jobs, solve, workers, max_in_flight, costs, schedule);
+
+    std::cerr << "Processed " << jobs.size() << " files, " << failed << " failed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Long-lived mode: one request per stdin line, one answer per stdout line.
+ * Answers are buffered and written out in batches: when the buffer fills up,
+ * or as soon as no further input is waiting, so an interactive client never
+ * waits on a half-full buffer. A request that fails answers "ERR <reason>".
+ * With latencies set, each request's stages are timed into them. A read is
+ * only timed when the line was already buffered, so time spent waiting for
+ * the client is not counted; each write sample is one flush.
+ */
+int run_stream(const Solver& solve, const FieldOp& op = {0, nullptr}, StageLatencies* latencies = nullptr) {
+    using clock = std::chrono::steady_clock;
+    std::string name = op.name ? op.name : "request";
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+
+    const size_t flush_bytes = 1 << 16;
+    std::string pending;
+    std::string line;
+    std::istringstream request;
+    std::ostringstream result;
+
+    while (true) {
+        bool buffered = std::cin.rdbuf()->in_avail() > 0;
+        auto read_start = clock::now();
+        if (!std::getline(std::cin, line)) break;
+        auto read_end = clock::now();
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        request.clear();
+        request.str(line);
+        result.str("");
+        try {
+            if (latencies) {
+                size_t bits = solve_timed(request, result, solve, op, *latencies);
+                if (buffered) latencies->record(STAGE_READ, name, bits, read_end - read_start);
+            } else {
+                solve(request, result);
+            }
+            if (!(request >> std::ws).eof()) throw std::runtime_error("Unexpected fields after the request");
+            pending += result.str();
+        } catch (const std::exception& ex) {
+            pending += "ERR ";
+            pending += ex.what();
+            pending += '\n';
+        }
+
+        if (pending.size() >= flush_bytes || std::cin.rdbuf()->in_avail() <= 0) {
+            auto write_start = clock::now();
+            std::cout.write(pending.data(), pending.size());
+            std::cout.flush();
+            pending.clear();
+            if (latencies) latencies->record(STAGE_WRITE, name, 0, clock::now() - write_start);
+        }
+    }
+    std::cout.write(pending.data(), pending.size());
+    std::cout.flush();
+    return 0;
+}
+
+/**
+ * @brief Bulk mode: the input file holds many requests back to back, each
+ * op.count tokens long. The file is memory-mapped and tokenized in place, and
+ * answers are written one line per request in large blocks. Operations with a
+ * modulus field are read in blocks of requests and solved grouped by modulus
+ * (see solve_block).
+ */
+int run_bulk(const std::string& input_filename, const std::string& output_filename, const FieldOp& op) {
+    std::ofstream outfile(output_filename, std::ios::binary);
+    if (!outfile) {
+        std::cerr << "Cannot open file for writing: " << output_filename << std::endl;
+        return 1;
+    }
+
+    try {
+        MappedInput input(input_filename);
+        const size_t flush_bytes = 1 << 20;
+        const size_t block_requests = op.modulus_field >= 0 ? 4096 : 1;
+        std::string pending;
+        std::vector<std::string_view> fields;
+        std::string_view field;
+        size_t requests = 0;
+        bool truncated = false;
+
+        while (!truncated) {
+            fields.clear();
+            while (fields.size() < block_requests * op.count && input.next_token(field)) fields.push_back(field);
+            if (fields.empty()) break;
+            if (fields.size() % op.count != 0) {
+                // The complete requests before the stray tokens are still answered
+                truncated = true;
+                fields.resize(fields.size() - fields.size() % op.count);
+            }
+            solve_block(fields, op, pending);
+            requests += fields.size() / op.count;
+
+            if (pending.size() >= flush_bytes) {
+                outfile.write(pending.data(), pending.size());
+                pending.clear();
+            }
+        }
+        outfile.write(pending.data(), pending.size());
+        std::cerr << "Processed " << requests << " requests" << std::endl;
+        if (truncated) {
+            std::cerr << "Truncated request at end of " << input_filename << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#if defined(__cpp_impl_coroutine)
+/**
+ * @brief One request as it moves through the pipeline stages.
+ */
+struct PipelineRecord {
+    size_t seq = 0;
+    std::string_view fields[8];
+    std::vector<BigInt> values;
+    std::string text;    // formatted answer line
+    std::string error;   // set by the first stage that fails
+};
+
+/**
+ * @brief Bulk input through a five-stage coroutine pipeline:
+ * read (tokenize the mapped file) -> parse (build BigInts) -> compute ->
+ * format (reversed hex) -> write (restore input order, buffered output).
+ * The cheap stages share one executor thread; compute gets one per core.
+ * Per-stage backpressure counters are printed when the run ends.
+ */
+int run_pipeline(const std::string& input_filename, const std::string& output_filename, const FieldOp& op) {
+    std::ofstream outfile(output_filename, std::ios::binary);
+    if (!outfile) {
+        std::cerr << "Cannot open file for writing: " << output_filename << std::endl;
+        return 1;
+    }
+    std::unique_ptr<MappedInput> input;
+    try {
+        input.reset(new MappedInput(input_filename));
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    size_t compute_workers = std::max(1u, std::thread::hardware_concurrency());
+    const size_t channel_capacity = 64 * compute_workers;
+    Executor io_executor(1, "io");
+    Executor compute_executor(compute_workers, "compute");
+
+    Channel<PipelineRecord> read_ch(channel_capacity), parse_ch(channel_capacity),
+                            compute_ch(channel_capacity), format_ch(channel_capacity);
+    StageMetrics read_m("read"), parse_m("parse"), compute_m("compute"), format_m("format"), write_m("write");
+    WaitGroup all, compute_group;
+    bool truncated = false;
+
+    auto read_stage = [&]() -> StageTask {
+        size_t seq = 0;
+        while (true) {
+            PipelineRecord rec;
+            if (!input->next_token(rec.fields[0])) break;
+            {
+                BusyTimer timer(read_m);
+                rec.seq = seq++;
+                for (size_t i = 1; i < op.count; ++i) {
+                    if (!input->next_token(rec.fields[i])) {
+                        truncated = true;
+                        break;
+                    }
+                }
+            }
+            if (truncated) break; // Reported at the end, with no answer line (as in --bulk)
+            co_await read_ch.push(std::move(rec), &read_m);
+        }
+        read_ch.close();
+        all.done();
+    };
+
+    auto parse_stage = [&]() -> StageTask {
+        PipelineRecord rec;
+        while (co_await read_ch.pop(rec, &parse_m)) {
+            {
+                BusyTimer timer(parse_m);
+                if (rec.error.empty()) {
+                    try {
+                        parse_fields(rec.fields, op.count, rec.values);
+                    } catch (const std::exception& ex) {
+                        rec.error = ex.what();
+                    }
+                }
+            }
+            co_await parse_ch.push(std::move(rec), &parse_m);
+        }
+        parse_ch.close();
+        all.done();
+    };
+
+    auto compute_stage = [&]() -> StageTask {
+        PipelineRecord rec;
+        while (co_await parse_ch.pop(rec, &compute_m)) {
+            {
+                BusyTimer timer(compute_m);
+                if (rec.error.empty()) {
+                    try {
+                        op.compute(rec.values);
+                    } catch (const std::exception& ex) {
+                        rec.error = ex.what();
+                    }
+                }
+            }
+            co_await compute_ch.push(std::move(rec), &compute_m);
+        }
+        if (compute_group.done()) compute_ch.close();
+        all.done();
+    };
+
+    auto format_stage = [&]() -> StageTask {
+        PipelineRecord rec;
+        while (co_await compute_ch.pop(rec, &format_m)) {
+            {
+                BusyTimer timer(format_m);
+                if (rec.error.empty()) format_results(rec.values, rec.text);
+                else rec.text = "ERR " + rec.error + "\n";
+                rec.values.clear();
+            }
+            co_await format_ch.push(std::move(rec), &format_m);
+        }
+        format_ch.close();
+        all.done();
+    };
+
+    auto write_stage = [&]() -> StageTask {
+        const size_t flush_bytes = 1 << 20;
+        std::map<size_t, std::string> early; // answers that overtook an earlier request
+        size_t next_seq = 0;
+        std::string pending;
+        PipelineRecord rec;
+        while (co_await format_ch.pop(rec, &write_m)) {
+            BusyTimer timer(write_m);
+            early.emplace(rec.seq, std::move(rec.text));
+            for (auto it = early.begin(); it != early.end() && it->first == next_seq; it = early.erase(it)) {
+                pending += it->second;
+                next_seq++;
+            }
+            if (pending.size() >= flush_bytes) {
+                outfile.write(pending.data(), pending.size());
+                pending.clear();
+            }
+        }
+        outfile.write(pending.data(), pending.size());
+        all.done();
+    };
+
+    all.add(4 + compute_workers);
+    compute_group.add(compute_workers);
+    write_stage().start_on(io_executor);
+    format_stage().start_on(io_executor);
+    for (size_t i = 0; i < compute_workers; ++i) compute_stage().start_on(compute_executor);
+    parse_stage().start_on(io_executor);
+    read_stage().start_on(io_executor);
+    all.wait();
+
+    for (const StageMetrics* m : {&read_m, &parse_m, &compute_m, &format_m, &write_m}) m->report(std::cerr);
+    if (truncated) {
+        std::cerr << "Truncated request at end of " << input_filename << std::endl;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+/**
+ * @brief Picks the run mode from the command line (see driver_main).
+ */
+int run_mode(int argc, char* argv[], const Solver& solve, const FieldOp& op, StageLatencies* latencies,
+             const SchedulerConfig& schedule) {
+    std::string program = argc > 0 ? argv[0] : "program";
+
+    if (argc >= 3 && argc <= 4 && std::string(argv[1]) == "--batch") {
+        return run_batch(argv[2], argc == 4 ? argv[3] : "", solve, op, latencies, schedule);
+    }
+    if (argc >= 3 && argc <= 4 && std::string(argv[1]) == "--batch-async") {
+        return run_batch_async(argv[2], argc == 4 ? argv[3] : "", solve, op, schedule);
+    }
+    if (argc == 2 && std::string(argv[1]) == "--stream") {
+        return run_stream(solve, op, latencies);
+    }
+    if (argc == 4 && op.count > 0 && std::string(argv[1]) == "--bulk") {
+        return run_bulk(argv[2], argv[3], op);
+    }
+#if defined(__cpp_impl_coroutine)
+    if (argc == 4 && op.count > 0 && std::string(argv[1]) == "--pipeline") {
+        return run_pipeline(argv[2], argv[3], op);
+    }
+#endif
+    if (argc == 3) {
+        return run_single(argv[1], argv[2], solve);
+    }
+
+    std::cerr << "Usage: " << program << " <input_file> <output_file>" << std::endl;
+    std::cerr << "       " << program << " --batch <dir|manifest> [output_dir]" << std::endl;
+    std::cerr << "       " << program << " --batch-async <dir|manifest> [output_dir]" << std::endl;
+    std::cerr << "       " << program << " --stream" << std::endl;
+    if (op.count > 0) {
+        std::cerr << "       " << program << " --bulk <input_file> <output_file>" << std::endl;
+#if defined(__cpp_impl_coroutine)
+        std::cerr << "       " << program << " --pipeline <input_file> <output_file>" << std::endl;
+#endif
+    }
+    std::cerr << "Add --stats to any mode to print the operation counters as JSON on stderr." << std::endl;
+    std::cerr << "Add --latency <file|-> [--latency-interval <seconds>] to --batch or --stream to export" << std::endl;
+    std::cerr << "per-stage latency histograms as JSON lines." << std::endl;
+    std::cerr << "Add --record <file> [--record-hashes] to any mode but --bulk and --pipeline to write a" << std::endl;
+    std::cerr << "request trace for trace_replay." << std::endl;
+    std::cerr << "Add --lane-weights <small,medium,large> (default 8,4,1) and --max-bypass <jobs> (default 64)" << std::endl;
+    std::cerr << "to --batch or --batch-async to tune the order in which files of different sizes run." << std::endl;
+    return 1;
+}
+
+/**
+ * @brief Shared entry point of the project drivers.
+ * Usage: program <input_file> <output_file>
+ *        program --batch <dir|manifest> [output_dir]
+ *        program --batch-async <dir|manifest> [output_dir]
+ *        program --stream
+ *        program --bulk <input_file> <output_file>   (when op.count > 0)
+ *        program --pipeline <input_file> <output_file>   (same, C++20 builds)
+ * --stats anywhere on the line dumps the BigInt operation counters at the end
+ * (all zero unless built with -DBIGINT_STATS).
+ * --latency <file|-> times the stages of batch and stream requests and appends
+ * the histograms to the file at the end, and every --latency-interval seconds;
+ * the other modes reject it.
+ * --record <file> writes every request to a trace (see trace.h), with operands
+ * reduced to their sizes and hashes under --record-hashes. Recording goes
+ * through the text Solver, so --bulk and --pipeline, whose input file is
+ * already a replayable request list, are not available with it.
+ * --lane-weights <s,m,l> and --max-bypass <jobs> tune the lane scheduler that
+ * orders batch files by estimated cost (see job_scheduler.h); a file is
+ * overdue once that many later files have run ahead of it.
+ */
+int driver_main(int argc, char* argv[], const Solver& solve, const FieldOp& op = {0, nullptr}) {
+    bool stats = false;
+    std::string latency_path;
+    double latency_interval = 0;
+    std::string record_path;
+    bool record_hashes = false;
+    SchedulerConfig schedule;
+    schedule.age_by_jobs = true; // Every batch file is queued at once
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (i > 0 && arg == "--stats") stats = true;
+        else if (i > 0 && arg == "--latency" && has_value) latency_path = argv[++i];
+        else if (i > 0 && arg == "--latency-interval" && has_value) latency_interval = std::atof(argv[++i]);
+        else if (i > 0 && arg == "--record" && has_value) record_path = argv[++i];
+        else if (i > 0 && arg == "--record-hashes") record_hashes = true;
+        else if (i > 0 && arg == "--max-bypass" && has_value) schedule.max_bypassed = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        else if (i > 0 && arg == "--lane-weights" && has_value) {
+            if (!parse_lane_weights(argv[++i], schedule)) {
+                std::cerr << "Lane weights must be three positive integers: small,medium,large" << std::endl;
+                return 1;
+            }
+        }
+        else args.push_back(argv[i]);
+    }
+
+    // Only the batch and stream loops time their stages; other modes would
+    // write empty histograms
+    if ((!latency_path.empty() || latency_interval != 0) && args.size() > 1) {
+        std::string mode = args[1];
+        if (mode != "--batch" && mode != "--stream") {
+            std::cerr << "--latency and --latency-interval are only available with --batch and --stream" << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<TraceRecorder> recorder;
+    Solver recording;
+    FieldOp recorded_op = op;
+    if (!record_path.empty()) {
+        try {
+            recorder = std::make_unique<TraceRecorder>(record_path, "driver", record_hashes);
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << std::endl;
+            return 1;
+        }
+        std::string name = op.name ? op.name : "request";
+        recording = [&solve, &recorder, name](std::istream& in, std::ostream& out) {
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            recorder->record(name, text);
+            std::istringstream request(text);
+            solve(request, out);
+        };
+        recorded_op = {0, nullptr, op.name, op.modulus_field, op.base_field};
+    }
+    const Solver& run_solve = recorder ? recording : solve;
+
+    int status;
+    if (latency_path.empty()) {
+        status = run_mode(static_cast<int>(args.size()), args.data(), run_solve, recorded_op, nullptr, schedule);
+    } else {
+        StageLatencies latencies;
+        LatencyExporter exporter(latencies, latency_path, latency_interval);
+        status = run_mode(static_cast<int>(args.size()), args.data(), run_solve, recorded_op, &latencies, schedule);
+    }
+    if (stats) {
+        std::cerr << bigint_stats_json(bigint_stats_total()) << std::endl;
+    }
+    return status;
+}
+
+#endif // DRIVER_H
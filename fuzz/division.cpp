@@ -0,0 +1,26 @@
+#include "fuzz_input.h"
+#include "../bigint_reference.h"
+
+// Truncated division: (a / b) * b + a % b == a, |a % b| < |b|, the remainder
+// takes the dividend's sign, and both match the bit-serial reference.
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FuzzInput in(data, size);
+    BigInt a = in.signed_operand(16);
+    BigInt b = in.signed_operand(12);
+    if (b.is_zero()) return 0;
+
+    auto qr = BigInt::divmod(a, b);
+    const BigInt& q = qr.first;
+    const BigInt& r = qr.second;
+    FUZZ_CHECK(q * b + r == a);
+    FUZZ_CHECK(r.abs() < b.abs());
+    FUZZ_CHECK(r.is_zero() || r.neg == a.neg);
+
+    auto ref = reference_divmod(a, b);
+    FUZZ_CHECK(q == ref.first);
+    FUZZ_CHECK(r == ref.second);
+    FUZZ_CHECK(a / b == q);
+    FUZZ_CHECK(a % b == r);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef FUZZ_INPUT_H
+#define FUZZ_INPUT_H
+
+// Shared pieces of the libFuzzer targets in this directory. Each target is one
+// translation unit defining LLVMFuzzerTestOneInput:
+//     clang++ -std=c++17 -O1 -g -fsanitize=fuzzer,address,undefined fuzz/division.cpp -o fuzz_division
+//     ./fuzz_division -max_len=4096 corpus_dir/
+// Without clang, -DFUZZ_STANDALONE adds a main() that runs the target over the
+// files named on the command line, to replay a crash or a saved corpus:
+//     g++ -std=c++17 -O1 -g -fsanitize=address,undefined -DFUZZ_STANDALONE fuzz/division.cpp -o fuzz_division
+//     ./fuzz_division crash-1234...
+// A broken invariant calls FUZZ_CHECK, which aborts so both setups report it.
+
+#include "../bigInt.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#define FUZZ_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::abort(); \
+        } \
+    } while (0)
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/**
+ * @brief Splits the fuzzer's bytes into operands. Each operand takes a length
+ * byte (bounded by max_limbs) and then that many limbs' worth of input bytes;
+ * once the input runs out, the remaining operands come out as zero.
+ */
+class FuzzInput {
+public:
+    FuzzInput(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint8_t byte() { return pos < size ? data[pos++] : 0; }
+
+    // A non-negative operand of up to max_limbs limbs; the length byte's high
+    // bit fills every limb with ones instead, to reach carry edge cases quickly
+    BigInt operand(size_t max_limbs) {
+        uint8_t header = byte();
+        size_t limbs = 1 + (header & 0x7F) % max_limbs;
+        BigInt x;
+        x.limbs.assign(limbs, 0);
+        for (size_t i = 0; i < limbs; ++i) {
+            uint64_t limb = 0;
+            for (int b = 0; b < 8; ++b) limb |= static_cast<uint64_t>(byte()) << (8 * b);
+            x.limbs[i] = (header & 0x80) ? ~limb : limb;
+        }
+        x.normalize();
+        return x;
+    }
+
+    BigInt signed_operand(size_t max_limbs) {
+        bool negative = (byte() & 1) != 0;
+        BigInt x = operand(max_limbs);
+        return negative ? -x : x;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+};
+
+#if defined(FUZZ_STANDALONE)
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::cerr << "Cannot read file: " << argv[i] << std::endl;
+            return 1;
+        }
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+    }
+    std::cerr << "Ran " << (argc - 1) << " inputs" << std::endl;
+    return 0;
+}
+#endif
+
+#endif // FUZZ_INPUT_H
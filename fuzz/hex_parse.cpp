@@ -0,0 +1,53 @@
+#include "fuzz_input.h"
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+// BigInt(const std::string&), from_reversed_hex and both formatters: the two
+// parsers must accept exactly the hex strings, agree with each other, and
+// format back to the canonical digits (uppercase, no leading zeros).
+
+static bool is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > 4096) return 0;
+    std::string text(reinterpret_cast<const char*>(data), size);
+    std::string reversed(text.rbegin(), text.rend());
+    bool valid = std::all_of(text.begin(), text.end(), is_hex);
+
+    BigInt big_endian, little_endian;
+    bool parsed_big = true, parsed_little = true;
+    try {
+        big_endian = BigInt(text);
+    } catch (const std::runtime_error&) {
+        parsed_big = false;
+    }
+    try {
+        little_endian = BigInt::from_reversed_hex(reversed);
+    } catch (const std::runtime_error&) {
+        parsed_little = false;
+    }
+    FUZZ_CHECK(parsed_big == valid);
+    FUZZ_CHECK(parsed_little == valid);
+    if (!valid) return 0;
+
+    FUZZ_CHECK(big_endian == little_endian);
+    FUZZ_CHECK(!big_endian.neg);
+
+    std::string canonical = text;
+    for (char& c : canonical) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    size_t first = canonical.find_first_not_of('0');
+    canonical = first == std::string::npos ? "0" : canonical.substr(first);
+
+    std::string hex = big_endian.to_hex_string();
+    std::string reversed_hex = big_endian.to_reversed_hex_string();
+    FUZZ_CHECK(hex == canonical);
+    FUZZ_CHECK(reversed_hex == std::string(canonical.rbegin(), canonical.rend()));
+    FUZZ_CHECK(BigInt(hex) == big_endian);
+    FUZZ_CHECK(BigInt::from_reversed_hex(reversed_hex) == big_endian);
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include "fuzz_input.h"
+#include "../rsa_ops.h"
+
+// mod_inverse for m >= 2 and a >= 0: when it finds an inverse, inv lies in
+// [0, m) and a * inv = 1 (mod m); when it does not, gcd(a, m) really is not 1.
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FuzzInput in(data, size);
+    BigInt a = in.operand(8);
+    BigInt m = in.operand(8);
+    if (m < BigInt(2)) return 0;
+
+    BigInt inv;
+    if (mod_inverse(a, m, inv)) {
+        FUZZ_CHECK(!inv.neg && inv < m);
+        FUZZ_CHECK((a * inv) % m == BigInt(1));
+    } else {
+        FUZZ_CHECK(gcd(a, m) != BigInt(1));
+    }
+    return 0;
+}
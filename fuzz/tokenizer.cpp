@@ -0,0 +1,20 @@
+#include "fuzz_input.h"
+#include "../mapped_input.h"
+
+// MappedInput::find_delimiter scans 16 bytes per step with SSE2: it must find
+// the same first delimiter as a byte-by-byte scan from every starting offset.
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    const char* p = reinterpret_cast<const char*>(data);
+    for (size_t start = 0; start <= size; ++start) {
+        size_t expected = size - start;
+        for (size_t i = start; i < size; ++i) {
+            if (MappedInput::is_delimiter(p[i])) {
+                expected = i - start;
+                break;
+            }
+        }
+        FUZZ_CHECK(MappedInput::find_delimiter(p + start, size - start) == expected);
+    }
+    return 0;
+}
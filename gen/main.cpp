@@ -0,0 +1,245 @@
+#include "../bigInt.h"
+#include "../miller_rabin.h"
+#include "../rsa_ops.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <cstdlib>
+
+// Synthetic workload generator. Emits requests in the reversed-hex format of
+// the projects, with a controlled bit-size mix:
+//     powmod  -> "n k x"   (project_01_03), modulus parity set by --odd-ratio
+//     inverse -> "p q e"   (project_01_02), p and q distinct primes
+//     isprime -> "n"       (project_01_01), primes mixed in by --prime-ratio
+//
+//     gen --op powmod|inverse|isprime --count N --bits <spec>
+//         [--seed S] [--odd-ratio R] [--prime-ratio R] [--e <reversed-hex>]
+//         [--prime-pool K] [--primes <file>] (--out <file> | --dir <dir>)
+//
+// <spec> is a comma-separated list of sizes with optional weights, e.g.
+// "2048:3,4096:1" draws 2048-bit operands three times as often as 4096-bit.
+// --out writes one request per line (the --bulk / --pipeline format);
+// --dir writes test_XXXXXX.inp files with one token per line (the test/ format).
+//
+// Prime generation costs full Miller-Rabin runs, so primes are drawn from a
+// pool of --prime-pool primes per size that is filled once and reused.
+// --primes preloads the pool with reversed-hex primes from a file (for example
+// ones made with another tool for sizes this library is too slow to search).
+
+struct SizeWeight {
+    size_t bits;
+    unsigned weight;
+};
+
+static std::vector<SizeWeight> parse_bits_spec(const std::string& spec) {
+    std::vector<SizeWeight> sizes;
+    std::stringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        size_t colon = item.find(':');
+        SizeWeight sw;
+        sw.bits = std::strtoull(item.substr(0, colon).c_str(), nullptr, 10);
+        sw.weight = colon == std::string::npos ? 1 : static_cast<unsigned>(std::strtoul(item.substr(colon + 1).c_str(), nullptr, 10));
+        if (sw.bits < 8 || sw.weight == 0) {
+            throw std::invalid_argument("Bad --bits entry: " + item);
+        }
+        sizes.push_back(sw);
+    }
+    if (sizes.empty()) {
+        throw std::invalid_argument("--bits needs at least one size");
+    }
+    return sizes;
+}
+
+// Exactly `bits` bits long
+static BigInt random_exact_bits(size_t bits) {
+    return random_bigint_in_range(BigInt(1) << (bits - 1), (BigInt(1) << bits) - BigInt(1));
+}
+
+static double random_unit() {
+    return (random_engine()() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Per-size pools of primes, filled lazily and reused.
+ */
+class PrimePool {
+public:
+    explicit PrimePool(size_t per_size) : per_size(per_size) {}
+
+    void preload(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+        std::string token;
+        while (file >> token) {
+            BigInt p = BigInt::from_reversed_hex(token);
+            pools[p.bit_length()].push_back(p);
+        }
+    }
+
+    const BigInt& draw(size_t bits) {
+        std::vector<BigInt>& pool = filled(bits);
+        return pool[random_engine()() % pool.size()];
+    }
+
+    // Redraws until the prime differs from `other`, so the p and q of one key
+    // are never equal. A pool whose primes all equal `other` (a preloaded
+    // file with a single prime of that size) gets one more.
+    const BigInt& draw_other(size_t bits, const BigInt& other) {
+        std::vector<BigInt>& pool = filled(bits);
+        if (std::all_of(pool.begin(), pool.end(), [&](const BigInt& p) { return p == other; })) {
+            BigInt p = generate_prime(bits);
+            while (p == other) p = generate_prime(bits);
+            pool.push_back(p);
+        }
+        while (true) {
+            const BigInt& p = pool[random_engine()() % pool.size()];
+            if (p != other) return p;
+        }
+    }
+
+private:
+    std::vector<BigInt>& filled(size_t bits) {
+        std::vector<BigInt>& pool = pools[bits];
+        while (pool.size() < per_size) {
+            std::cerr << "Generating " << bits << "-bit prime " << pool.size() + 1 << "/" << per_size << std::endl;
+            pool.push_back(generate_prime(bits));
+        }
+        return pool;
+    }
+
+
+    size_t per_size;
+    std::map<size_t, std::vector<BigInt>> pools;
+};
+
+// Odd and divisible by 3, so certainly composite
+static BigInt random_composite(size_t bits) {
+    while (true) {
+        BigInt c = random_exact_bits(bits);
+        c = c - BigInt(c.mod_small(3));
+        if (c.is_even()) c = c + BigInt(3);
+        if (c.bit_length() == bits && c > BigInt(3)) return c;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string op, bits_spec, out_path, dir_path, primes_path, e_str = "10001";
+    size_t count = 0, prime_pool = 4;
+    uint64_t seed = 1;
+    double odd_ratio = 1.0, prime_ratio = 0.5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--op" && has_value) op = argv[++i];
+        else if (arg == "--count" && has_value) count = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--bits" && has_value) bits_spec = argv[++i];
+        else if (arg == "--seed" && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--odd-ratio" && has_value) odd_ratio = std::atof(argv[++i]);
+        else if (arg == "--prime-ratio" && has_value) prime_ratio = std::atof(argv[++i]);
+        else if (arg == "--e" && has_value) e_str = argv[++i];
+        else if (arg == "--prime-pool" && has_value) prime_pool = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--primes" && has_value) primes_path = argv[++i];
+        else if (arg == "--out" && has_value) out_path = argv[++i];
+        else if (arg == "--dir" && has_value) dir_path = argv[++i];
+        else {
+            op.clear();
+            break;
+        }
+    }
+    if ((op != "powmod" && op != "inverse" && op != "isprime") || bits_spec.empty() || count == 0 || out_path.empty() == dir_path.empty()) {
+        std::cerr << "Usage: " << (argc > 0 ? argv[0] : "program") << " --op powmod|inverse|isprime --count N --bits <spec>" << std::endl;
+        std::cerr << "       [--seed S] [--odd-ratio R] [--prime-ratio R] [--e <reversed-hex>]" << std::endl;
+        std::cerr << "       [--prime-pool K] [--primes <file>] (--out <file> | --dir <dir>)" << std::endl;
+        return 1;
+    }
+    if (op == "inverse" && prime_pool < 2) {
+        std::cerr << "--op inverse needs --prime-pool 2 or more so that p and q can differ" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::vector<SizeWeight> sizes = parse_bits_spec(bits_spec);
+        unsigned total_weight = 0;
+        for (const auto& sw : sizes) total_weight += sw.weight;
+
+        seed_random(seed);
+        PrimePool primes(prime_pool);
+        if (!primes_path.empty()) primes.preload(primes_path);
+        BigInt e = BigInt::from_reversed_hex(e_str);
+
+        std::ofstream bulk;
+        if (!out_path.empty()) {
+            bulk.open(out_path, std::ios::binary);
+            if (!bulk) {
+                std::cerr << "Cannot open file for writing: " << out_path << std::endl;
+                return 1;
+            }
+        } else {
+            std::filesystem::create_directories(dir_path);
+        }
+
+        const size_t flush_bytes = 1 << 20;
+        std::string pending;
+        std::vector<BigInt> fields;
+        for (size_t r = 0; r < count; ++r) {
+            unsigned pick = static_cast<unsigned>(random_engine()() % total_weight);
+            size_t bits = sizes.back().bits;
+            for (const auto& sw : sizes) {
+                if (pick < sw.weight) { bits = sw.bits; break; }
+                pick -= sw.weight;
+            }
+
+            fields.clear();
+            if (op == "powmod") {
+                BigInt n = random_exact_bits(bits);
+                bool odd = random_unit() < odd_ratio;
+                if (odd == n.is_even()) n.limbs[0] ^= 1; // Flipping bit 0 keeps the size
+                fields.push_back(n);
+                fields.push_back(random_exact_bits(bits));
+                fields.push_back(random_bigint_in_range(BigInt(0), n - BigInt(1)));
+            } else if (op == "inverse") {
+                BigInt p = primes.draw(bits - bits / 2);
+                fields.push_back(p);
+                fields.push_back(primes.draw_other(bits / 2, p));
+                fields.push_back(e);
+            } else {
+                fields.push_back(random_unit() < prime_ratio ? primes.draw(bits) : random_composite(bits));
+            }
+
+            if (bulk.is_open()) {
+                for (size_t i = 0; i < fields.size(); ++i) {
+                    if (i > 0) pending += ' ';
+                    pending += fields[i].to_reversed_hex_string();
+                }
+                pending += '\n';
+                if (pending.size() >= flush_bytes) {
+                    bulk.write(pending.data(), pending.size());
+                    pending.clear();
+                }
+            } else {
+                std::ostringstream name;
+                name << "test_" << std::setw(6) << std::setfill('0') << r << ".inp";
+                std::ofstream file(std::filesystem::path(dir_path) / name.str());
+                if (!file) {
+                    std::cerr << "Cannot open file for writing: " << name.str() << std::endl;
+                    return 1;
+                }
+                for (const BigInt& f : fields) file << f.to_reversed_hex_string() << '\n';
+            }
+        }
+        if (bulk.is_open()) bulk.write(pending.data(), pending.size());
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
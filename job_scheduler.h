@@ -0,0 +1,203 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+// Cost-aware ordering for mixed-size job queues (batch files, daemon requests).
+// Every job gets an estimated cost from its operation and operand size and is
+// queued in one of three lanes: small, medium or large. The lanes take turns by
+// smooth weighted round-robin, so with the default weights 8:4:1 small jobs keep
+// moving while large ones queue up. A job that has waited longer than max_wait
+// goes before everything else, oldest first, so no lane can starve; a max_wait
+// of 0 turns the scheduler into a plain FIFO. A batch queues all its jobs at
+// once, so wall time would soon make every job overdue; batches age jobs by how
+// many later jobs were served past them instead (age_by_jobs, max_bypassed).
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <system_error>
+#include <cstdint>
+#include <cstdlib>
+
+enum CostLane { LANE_SMALL, LANE_MEDIUM, LANE_LARGE, LANE_COUNT };
+
+// Lane boundaries in estimated word operations: a 1024-bit powmod is small,
+// 2048 to 4096 bits is medium, and an 8192-bit powmod or keygen is large
+static const double lane_medium_cost = double(1 << 20);
+static const double lane_large_cost = double(1 << 27);
+
+/**
+ * @brief Lane weights (how many turns each lane gets per round) and the age
+ * after which a job is served ahead of its lane: max_wait of wall time, or
+ * with age_by_jobs, max_bypassed later jobs served past it.
+ */
+struct SchedulerConfig {
+    unsigned weights[LANE_COUNT] = {8, 4, 1};
+    std::chrono::milliseconds max_wait{500};
+    bool age_by_jobs = false;
+    size_t max_bypassed = 64;
+};
+
+/**
+ * @brief Parses lane weights written as "small,medium,large", e.g. "8,4,1".
+ * Every weight must be at least 1. Returns false on a malformed list.
+ */
+bool parse_lane_weights(const std::string& text, SchedulerConfig& config) {
+    unsigned weights[LANE_COUNT];
+    size_t pos = 0;
+    for (size_t l = 0; l < LANE_COUNT; ++l) {
+        size_t end = text.find(',', pos);
+        if ((end == std::string::npos) != (l + 1 == LANE_COUNT)) return false;
+        std::string field = text.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+        char* rest = nullptr;
+        unsigned long value = std::strtoul(field.c_str(), &rest, 10);
+        if (field.empty() || *rest != '\0' || value == 0 || value > 1000000) return false;
+        weights[l] = static_cast<unsigned>(value);
+        pos = end + 1;
+    }
+    std::copy(weights, weights + LANE_COUNT, config.weights);
+    return true;
+}
+
+/**
+ * @brief Estimated cost of one operation in word operations, from its name
+ * and its size in bits (the largest operand, or the requested key size for
+ * keygen). Only the ratios between jobs matter.
+ */
+double estimate_cost(const std::string& op, size_t bits) {
+    auto modexp = [](size_t b) {
+        double words = static_cast<double>(std::max<size_t>(1, (b + 63) / 64));
+        return words * words * static_cast<double>(std::max<size_t>(b, 64));
+    };
+    if (op == "isprime") return 40 * modexp(bits); // Miller-Rabin rounds
+    if (op == "inverse") return 4 * static_cast<double>(bits) * static_cast<double>((bits + 63) / 64 + 1);
+    if (op == "keygen") return static_cast<double>(bits / 4 + 80) * modexp(bits / 2); // Candidates plus the final rounds
+    if (op == "factor") return 1024 * modexp(bits);
+    return modexp(bits);
+}
+
+/**
+ * @brief Estimated cost of one request from its operands in the drivers' text
+ * format: reversed-hex operands, or "<bits> [e]" for keygen and
+ * "<bits> <iterations>" for bench.
+ */
+double estimate_request_cost(const std::string& op, std::string_view text) {
+    std::string_view tokens[2];
+    size_t count = 0, longest = 0, pos = 0;
+    while (true) {
+        size_t start = text.find_first_not_of(" \t\r\n", pos);
+        if (start == std::string_view::npos) break;
+        size_t end = std::min(text.find_first_of(" \t\r\n", start), text.size());
+        if (count < 2) tokens[count] = text.substr(start, end - start);
+        longest = std::max(longest, end - start);
+        count++;
+        pos = end;
+    }
+
+    if (op == "keygen" || op == "bench") {
+        size_t bits = count > 0 ? std::strtoul(std::string(tokens[0]).c_str(), nullptr, 10) : 0;
+        double iterations = count > 1 ? std::strtod(std::string(tokens[1]).c_str(), nullptr) : 1;
+        if (op == "keygen") return estimate_cost(op, bits);
+        return 2 * std::max(1.0, iterations) * estimate_cost("powmod", bits);
+    }
+    return estimate_cost(op, 4 * longest);
+}
+
+/**
+ * @brief Estimated cost of a request file from its size alone, as if it held
+ * one operand as long as the file, so planning a batch never reads the
+ * inputs ahead of the batch's own I/O. keygen and bench files hold a size
+ * rather than operands, so theirs all cost about the same.
+ */
+double estimate_file_cost(const std::string& op, const std::string& path) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) return 0; // Fails fast when it runs
+    return estimate_cost(op, 4 * static_cast<size_t>(size));
+}
+
+/**
+ * @brief The lane a job of this estimated cost is queued in.
+ */
+CostLane cost_lane(double cost) {
+    if (cost < lane_medium_cost) return LANE_SMALL;
+    if (cost < lane_large_cost) return LANE_MEDIUM;
+    return LANE_LARGE;
+}
+
+/**
+ * @brief Queue of jobs in cost lanes (see the top of this file). Not
+ * thread-safe: callers that share one hold their own lock around it.
+ */
+template <typename Job>
+class LaneScheduler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit LaneScheduler(const SchedulerConfig& config = SchedulerConfig()) : config(config) {}
+
+    void push(Job job, double cost, clock::time_point now = clock::now()) {
+        lanes[cost_lane(cost)].push_back({std::move(job), now, pushed++});
+        queued++;
+    }
+
+    // Takes the oldest overdue job, or else the head of the lane whose turn it
+    // is. False when nothing is queued.
+    bool pop(Job& job, clock::time_point now = clock::now()) {
+        if (queued == 0) return false;
+        size_t pick = LANE_COUNT;
+        for (size_t l = 0; l < LANE_COUNT; ++l) {
+            if (lanes[l].empty() || !overdue(l, now)) continue;
+            if (pick == LANE_COUNT || lanes[l].front().order < lanes[pick].front().order) pick = l;
+        }
+        if (pick == LANE_COUNT) {
+            long total = 0;
+            for (size_t l = 0; l < LANE_COUNT; ++l) {
+                if (lanes[l].empty()) {
+                    credit[l] = 0; // An idle lane banks no turns
+                    continue;
+                }
+                credit[l] += config.weights[l];
+                total += config.weights[l];
+                if (pick == LANE_COUNT || credit[l] > credit[pick]) pick = l;
+            }
+            credit[pick] -= total;
+        }
+
+        uint64_t served = lanes[pick].front().order;
+        job = std::move(lanes[pick].front().job);
+        lanes[pick].pop_front();
+        queued--;
+        for (size_t l = 0; l < LANE_COUNT; ++l) {
+            if (l == pick || lanes[l].empty()) bypassed[l] = 0; // A new head starts afresh
+            else if (served > lanes[l].front().order) bypassed[l]++;
+        }
+        return true;
+    }
+
+    size_t size() const { return queued; }
+    bool empty() const { return queued == 0; }
+
+private:
+    bool overdue(size_t lane, clock::time_point now) const {
+        if (config.age_by_jobs) return bypassed[lane] >= config.max_bypassed;
+        return now - lanes[lane].front().since >= config.max_wait;
+    }
+
+    struct Entry {
+        Job job;
+        clock::time_point since;
+        uint64_t order; // Push order, which also breaks ties between equal times
+    };
+
+    SchedulerConfig config;
+    std::deque<Entry> lanes[LANE_COUNT];
+    long credit[LANE_COUNT] = {};
+    size_t bypassed[LANE_COUNT] = {}; // later jobs served past each lane's head
+    size_t queued = 0;
+    uint64_t pushed = 0;
+};
+
+#endif // JOB_SCHEDULER_H
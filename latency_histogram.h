@@ -0,0 +1,191 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+// Per-stage latency histograms for the driver modes. Each request is timed
+// through read -> parse -> compute -> format -> write, and every sample lands in
+// the histogram of its (stage, operation, operand size class). The histograms
+// are log-linear like HdrHistogram: exact below 128 ns, then 128 sub-buckets per
+// power of two, so any percentile is within 1% of the true sample value.
+
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdint>
+#include <cmath>
+#include <ctime>
+
+/**
+ * @brief Log-linear histogram of nanosecond samples.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram() : counts(buckets, 0) {}
+
+    void record(uint64_t ns) {
+        counts[index_of(ns)]++;
+        if (total == 0 || ns < min_ns) min_ns = ns;
+        if (ns > max_ns) max_ns = ns;
+        total++;
+        sum_ns += static_cast<double>(ns);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return min_ns; }
+    uint64_t max() const { return max_ns; }
+    double mean() const { return total ? sum_ns / total : 0; }
+
+    // The sample at quantile q (0..1), to the histogram's precision
+    uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(std::max(value_of(i), min_ns), max_ns);
+        }
+        return max_ns;
+    }
+
+private:
+    static const unsigned sub_bits = 7;
+    static const size_t sub_count = size_t(1) << sub_bits;
+    static const size_t buckets = sub_count * (64 - sub_bits + 1);
+
+    static size_t index_of(uint64_t v) {
+        if (v < sub_count) return static_cast<size_t>(v);
+        unsigned exp = 63 - static_cast<unsigned>(__builtin_clzll(v));
+        size_t sub = static_cast<size_t>(v >> (exp - sub_bits)) - sub_count;
+        return sub_count * (exp - sub_bits + 1) + sub;
+    }
+
+    // Middle of the value range bucket i covers
+    static uint64_t value_of(size_t i) {
+        if (i < sub_count) return i;
+        unsigned shift = static_cast<unsigned>(i / sub_count - 1);
+        uint64_t low = static_cast<uint64_t>(sub_count + i % sub_count) << shift;
+        return low + ((uint64_t(1) << shift) - 1) / 2;
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0, min_ns = 0, max_ns = 0;
+    double sum_ns = 0;
+};
+
+enum LatencyStage {
+    STAGE_READ,
+    STAGE_PARSE,
+    STAGE_COMPUTE,
+    STAGE_FORMAT,
+    STAGE_WRITE,
+    STAGE_COUNT
+};
+
+static const char* const latency_stage_names[STAGE_COUNT] = {"read", "parse", "compute", "format", "write"};
+
+/**
+ * @brief Histograms keyed by stage, operation and operand size class.
+ * Recording and exporting may happen on different threads.
+ */
+class StageLatencies {
+public:
+    // Size classes are powers of two from 64 bits up; 0 means the size is unknown
+    static size_t size_class(size_t bits) {
+        if (bits == 0) return 0;
+        size_t c = 64;
+        while (c < bits) c <<= 1;
+        return c;
+    }
+
+    void record(LatencyStage stage, const std::string& op, size_t bits, std::chrono::steady_clock::duration elapsed) {
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        std::lock_guard<std::mutex> lock(mutex);
+        histograms[std::make_tuple(op, size_class(bits), stage)].record(ns);
+    }
+
+    // One JSON object with every histogram's summary
+    void write_json(std::ostream& out, bool final) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "{\"time\": " << std::time(nullptr) << ", \"final\": " << (final ? "true" : "false") << ", \"histograms\": [";
+        bool first = true;
+        for (const auto& entry : histograms) {
+            const LatencyHistogram& h = entry.second;
+            size_t bits = std::get<1>(entry.first);
+            out << (first ? "" : ", ") << "{\"stage\": \"" << latency_stage_names[std::get<2>(entry.first)]
+                << "\", \"op\": \"" << std::get<0>(entry.first) << "\", \"bits\": ";
+            if (bits) out << bits;
+            else out << "null";
+            out << ", \"count\": " << h.count() << ", \"min_ns\": " << h.min()
+                << ", \"p50_ns\": " << h.percentile(0.50) << ", \"p90_ns\": " << h.percentile(0.90)
+                << ", \"p99_ns\": " << h.percentile(0.99) << ", \"p999_ns\": " << h.percentile(0.999)
+                << ", \"max_ns\": " << h.max() << ", \"mean_ns\": " << static_cast<uint64_t>(h.mean()) << "}";
+            first = false;
+        }
+        out << "]}" << std::endl;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::tuple<std::string, size_t, LatencyStage>, LatencyHistogram> histograms;
+};
+
+/**
+ * @brief Appends StageLatencies snapshots as JSON lines to a file ("-" for
+ * stderr): every interval_seconds when that is positive, and once more when
+ * destroyed.
+ */
+class LatencyExporter {
+public:
+    LatencyExporter(const StageLatencies& latencies, const std::string& path, double interval_seconds)
+        : latencies(latencies), path(path) {
+        if (interval_seconds > 0) {
+            auto interval = std::chrono::duration<double>(interval_seconds);
+            worker = std::thread([this, interval] {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+                    export_now(false);
+                }
+            });
+        }
+    }
+
+    ~LatencyExporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (worker.joinable()) worker.join();
+        export_now(true);
+    }
+
+private:
+    void export_now(bool final) {
+        if (path == "-") {
+            latencies.write_json(std::cerr, final);
+            return;
+        }
+        std::ofstream file(path, std::ios::app);
+        if (!file) {
+            std::cerr << "Cannot open file for writing: " << path << std::endl;
+            return;
+        }
+        latencies.write_json(file, final);
+    }
+
+    const StageLatencies& latencies;
+    std::string path;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+#endif // LATENCY_HISTOGRAM_H
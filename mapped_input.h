@@ -0,0 +1,101 @@
+#ifndef MAPPED_INPUT_H
+#define MAPPED_INPUT_H
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Read-only memory map of an input file, split into whitespace-separated
+ * tokens in place. Tokens are views into the mapping and stay valid as long as
+ * the MappedInput lives; nothing is copied.
+ */
+class MappedInput {
+public:
+    explicit MappedInput(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat file: " + path);
+        }
+        size = static_cast<size_t>(st.st_size);
+        if (size > 0) {
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Cannot map file: " + path);
+            }
+            data = static_cast<const char*>(mapped);
+            madvise(mapped, size, MADV_SEQUENTIAL);
+        }
+        close(fd); // The mapping keeps the file contents reachable
+    }
+
+    ~MappedInput() {
+        if (data) munmap(const_cast<char*>(data), size);
+    }
+
+    MappedInput(const MappedInput&) = delete;
+    MappedInput& operator=(const MappedInput&) = delete;
+
+    // Hands out the next token; returns false at the end of the file
+    bool next_token(std::string_view& token) {
+        while (pos < size && is_delimiter(data[pos])) pos++;
+        if (pos >= size) return false;
+
+        size_t len = find_delimiter(data + pos, size - pos);
+        token = std::string_view(data + pos, len);
+        pos += len;
+        return true;
+    }
+
+    size_t bytes() const { return size; }
+
+    // The tokenizer itself; public so the fuzz target can check it on raw bytes
+    static bool is_delimiter(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    // Offset of the first delimiter in p[0, n), or n when there is none.
+    // Hex tokens run for dozens of bytes, so 16 bytes are checked per step.
+    static size_t find_delimiter(const char* p, size_t n) {
+        size_t i = 0;
+    #if defined(__SSE2__)
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i carriage = _mm_set1_epi8('\r');
+        const __m128i tab = _mm_set1_epi8('\t');
+        for (; i + 16 <= n; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, newline)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage), _mm_cmpeq_epi8(chunk, tab)));
+            int mask = _mm_movemask_epi8(hits);
+            if (mask != 0) return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    #endif
+        for (; i < n; ++i) {
+            if (is_delimiter(p[i])) return i;
+        }
+        return n;
+    }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+};
+
+#endif // MAPPED_INPUT_H
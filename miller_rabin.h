@@ -2,12 +2,26 @@
 #define MILLER_RABIN_H
 
 #include "bigInt.h"
+#include "montgomery.h"
 #include <random>    // For std::mt19937_64
 
 /**
  * @brief Performs modular exponentiation (base^exp) % mod.
+ * Odd moduli go through a per-thread Montgomery context, which is only rebuilt
+ * when the modulus changes; even moduli use plain square-and-multiply.
  */
 BigInt powMod(BigInt base, BigInt exp, const BigInt& mod) {
+    BIGINT_COUNT(STAT_MODEXPS, 1);
+    if (!mod.is_even() && !mod.neg && mod > BigInt(1)) {
+        static thread_local MontgomeryContext context;
+        if (context.limbs() == 0 || context.modulus() != mod) context.reset(mod);
+        base %= mod;
+        if (base.neg) base += mod;
+        BigInt result;
+        context.pow(base, exp, result);
+        return result;
+    }
+
     BigInt result(1);
     base %= mod;
     while (exp > 0) {
@@ -20,13 +34,27 @@ BigInt powMod(BigInt base, BigInt exp, const BigInt& mod) {
     return result;
 }
 
+/**
+ * @brief The per-thread generator behind random_bigint_in_range.
+ * Seeded from std::random_device unless seed_random() is called first.
+ */
+std::mt19937_64& random_engine() {
+    static thread_local std::mt19937_64 gen{std::random_device{}()};
+    return gen;
+}
+
+/**
+ * @brief Reseeds this thread's generator, for reproducible runs (e.g. the gen tool).
+ */
+void seed_random(uint64_t seed) {
+    random_engine().seed(seed);
+}
+
 /**
  * @brief Generates a cryptographically secure random BigInt in [min, max].
  */
 BigInt random_bigint_in_range(const BigInt& min, const BigInt& max) {
-    // Create a static generator to be seeded only once
-    static std::random_device rd;
-    static std::mt19937_64 gen(rd());
+    std::mt19937_64& gen = random_engine();
 
     BigInt range = max - min + BigInt(1);
     if (range <= BigInt(0)) {
@@ -64,58 +92,101 @@ BigInt random_bigint_in_range(const BigInt& min, const BigInt& max) {
 }
 
 /**
- * @brief Checks if the number is probably prime using Miller-Rabin.
+ * @brief Draws a uniform value in [0, bound) into out, reusing out's limbs:
+ * no allocation once out has room for bound's limbs.
  */
-bool is_prime_miller_rabin(const BigInt& n, int k) {
-    // --- Step 1: Handle edge cases ---
-    if (n < BigInt(2)) return false;
-    if (n == BigInt(2) || n == BigInt(3)) return true;
-    if (n.is_even()) return false;
+void random_below(const BigInt& bound, BigInt& out) {
+    std::mt19937_64& gen = random_engine();
+    size_t bits = bound.bit_length();
+    size_t num_limbs = bound.limbs.size();
+    out.neg = false;
+    do {
+        out.limbs.resize(num_limbs);
+        for (size_t i = 0; i < num_limbs; ++i) out.limbs[i] = gen();
+        if (bits % 64 != 0) out.limbs.back() &= (1ULL << (bits % 64)) - 1;
+        out.normalize();
+    } while (!(out < bound)); // Rejection sampling
+}
 
-    // --- Step 2: Find d and r such that n-1 = d * 2^r ---
-    BigInt n_minus_1 = n - BigInt(1);
-    BigInt d = n_minus_1;
-    size_t r = 0;
-    while (d.is_even()) {
-        d = d >> 1;
-        r++;
+/**
+ * @brief Miller-Rabin rounds against one odd n >= 5. The constructor does all
+ * the setup (n - 1 = d * 2^r, the Montgomery context, the buffers), so each
+ * round afterwards runs without touching the heap.
+ */
+class MillerRabinTester {
+public:
+    explicit MillerRabinTester(const BigInt& n) : context(n) {
+        // --- Find d and r such that n-1 = d * 2^r ---
+        d = n - BigInt(1);
+        while (d.is_even()) {
+            d = d >> 1;
+            r++;
+        }
+        base_bound = n - BigInt(3); // Bases are drawn from [2, n-2]
+        base.limbs.reserve(n.limbs.size() + 1);
+        x.assign(n.limbs.size(), 0);
     }
-    
-    BigInt n_minus_2 = n - BigInt(2); // For random range [2, n-2]
 
-    // --- Step 3: Witness loop (k rounds) ---
-    for (int i = 0; i < k; ++i) {
-        // Pick a random base 'a' in the range [2, n-2]
-        // Calls the free function
-        BigInt a = random_bigint_in_range(BigInt(2), n_minus_2);
+    /**
+     * @brief One round with a random base; false means n is certainly composite.
+     */
+    bool round() {
+        random_below(base_bound, base);
+        uint64_t carry = 2;
+        for (size_t i = 0; i < base.limbs.size() && carry; ++i) base.limbs[i] = BigInt::add_carry(base.limbs[i], 0, carry);
+        if (carry) base.limbs.push_back(carry);
+        return round(base);
+    }
 
-        // --- Step 4: Compute x = a^d % n ---
-        // Calls the free function
-        BigInt x = powMod(a, d, n);
+    /**
+     * @brief One round with the given base a in [2, n-2].
+     */
+    bool round(const BigInt& a) {
+        BIGINT_COUNT(STAT_MR_ROUNDS, 1);
+        BIGINT_COUNT(STAT_MODEXPS, 1); // a^d runs on the context directly, not through powMod
 
-        // If x is 1 or n-1, it might be prime. Continue to next witness.
-        if (x == BigInt(1) || x == n_minus_1) {
-            continue;
+        // --- Compute x = a^d mod n ---
+        context.pow_montgomery(a, d, x.data());
+
+        // If x is 1 or n-1, it might be prime
+        if (context.equal(x.data(), context.one()) || context.equal(x.data(), context.minus_one())) {
+            return true;
         }
 
-        // --- Step 5: Squaring loop (r-1 times) ---
-        bool probably_prime = false;
-        for (size_t j = 0; j < r - 1; ++j) {
-            x = (x * x) % n;
-            
-            if (x == n_minus_1) {
-                probably_prime = true;
-                break;
-            }
+        // --- Squaring loop (r-1 times) ---
+        for (size_t j = 0; j + 1 < r; ++j) {
+            context.mul(x.data(), x.data(), x.data());
+            if (context.equal(x.data(), context.minus_one())) return true;
         }
+        return false;
+    }
 
-        // --- Step 6: Verdict for this witness ---
-        if (!probably_prime) {
+private:
+    MontgomeryContext context;
+    BigInt d, base_bound, base;
+    size_t r = 0;
+    LimbVector x;
+};
+
+/**
+ * @brief Checks if the number is probably prime using Miller-Rabin.
+ */
+bool is_prime_miller_rabin(const BigInt& n, int k) {
+    // --- Step 1: Handle edge cases ---
+    if (n < BigInt(2)) return false;
+    if (n == BigInt(2) || n == BigInt(3)) return true;
+    if (n.is_even()) return false;
+
+    // --- Step 2: Witness loop (k rounds) ---
+    MillerRabinTester tester(n);
+    for (int i = 0; i < k; ++i) {
+        if (!tester.round()) {
+            if (i + 1 < k) BIGINT_COUNT(STAT_MR_EARLY_EXITS, 1); // Failing the last round is no early exit
             return false;
         }
     }
 
-    // --- Step 7: Final verdict ---
+    // --- Step 3: Final verdict ---
     return true;
 }
 
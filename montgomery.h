@@ -0,0 +1,335 @@
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include "bigInt.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <cstdlib>
+
+// From this modulus size in limbs (e.g. 128 = 8192 bits) pow() splits each
+// modular multiplication across WorkPool::shared() when the pool has workers.
+// Off (0) by default: in the batch and daemon modes every core already runs its own
+// request, and the split product does more limb multiplies than CIOS, so it
+// only pays for a single huge request on an otherwise idle machine. The
+// BIGINT_PARALLEL_POWMOD environment variable sets it at startup.
+#ifndef BIGINT_PARALLEL_POWMOD_THRESHOLD
+#define BIGINT_PARALLEL_POWMOD_THRESHOLD 0
+#endif
+
+/**
+ * @brief The parallel pow() threshold in limbs: BIGINT_PARALLEL_POWMOD from the
+ * environment when set, else BIGINT_PARALLEL_POWMOD_THRESHOLD. 0 means off.
+ */
+size_t parallel_powmod_limbs() {
+    const char* env = std::getenv("BIGINT_PARALLEL_POWMOD");
+    long limbs = env ? std::atol(env) : BIGINT_PARALLEL_POWMOD_THRESHOLD;
+    return limbs > 0 ? static_cast<size_t>(limbs) : 0;
+}
+
+/**
+ * @brief Montgomery arithmetic modulo one odd modulus n > 1.
+ * Values are kept as n-limb arrays in Montgomery form (x * R mod n with
+ * R = 2^(64 * limbs)), so a modular product costs one interleaved
+ * multiply-and-reduce pass instead of a product plus a bit-serial division.
+ * All buffers are sized by reset(): once a context is set up, mul() and pow()
+ * never allocate, as long as the output BigInt already has room for n limbs.
+ * Moduli past an opt-in size take the parallel path instead (see
+ * parallel_limbs and mul_parallel), which does.
+ */
+class MontgomeryContext {
+public:
+    // Runtime copy of BIGINT_PARALLEL_POWMOD_THRESHOLD; 0 keeps pow() on one thread
+    static inline size_t parallel_limbs = parallel_powmod_limbs();
+
+    MontgomeryContext() = default;
+    explicit MontgomeryContext(const BigInt& modulus) { reset(modulus); }
+
+    // Switches to a new modulus; buffers are reused when they are large enough
+    void reset(const BigInt& modulus) {
+        if (modulus.neg || modulus.is_even() || modulus <= BigInt(1)) {
+            throw std::invalid_argument("Montgomery modulus must be odd and greater than 1");
+        }
+        mod = modulus;
+        n = mod.limbs.size();
+        m_prime.clear(); // The parallel path derives it on first use
+        table_entries = 0;
+        const uint64_t* m = mod.limbs.data();
+
+        // -m^-1 mod 2^64 by Newton's iteration: each step doubles the correct bits
+        uint64_t inv = m[0];
+        for (int i = 0; i < 6; ++i) inv *= 2 - m[0] * inv;
+        m_inv = ~inv + 1;
+
+        t.assign(n + 2, 0);
+        padded.assign(n, 0);
+        r2.assign(n, 0);
+        one_m.assign(n, 0);
+        minus_one_m.assign(n, 0);
+        acc.assign(n, 0);
+
+        // R^2 mod n once with BigInt division; R mod n is then R^2 * R^-1
+        BigInt r2_big = (BigInt(1) << (128 * n)) % mod;
+        std::copy(r2_big.limbs.begin(), r2_big.limbs.end(), r2.begin());
+        padded[0] = 1;
+        mul(padded.data(), r2.data(), one_m.data());
+        std::copy(m, m + n, minus_one_m.begin());
+        BigInt::sub_in_place(minus_one_m.data(), n, one_m.data(), n); // (n - 1) R = n - R mod n
+    }
+
+    const BigInt& modulus() const { return mod; }
+    size_t limbs() const { return n; }
+
+    // R mod n and (n - 1) R mod n: 1 and -1 in Montgomery form
+    const uint64_t* one() const { return one_m.data(); }
+    const uint64_t* minus_one() const { return minus_one_m.data(); }
+
+    bool equal(const uint64_t* a, const uint64_t* b) const { return std::equal(a, a + n, b); }
+
+    /**
+     * @brief r = a * b * R^-1 mod n for a, b < n (CIOS). r may alias a or b.
+     */
+    void mul(const uint64_t* a, const uint64_t* b, uint64_t* r) {
+        const uint64_t* m = mod.limbs.data();
+        uint64_t* tp = t.data();
+        std::fill(tp, tp + n + 2, 0);
+        BIGINT_COUNT(STAT_LIMB_MULS, 2 * n * n);
+
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < n; ++j) {
+                tp[j] = BigInt::mul_add(a[i], b[j], tp[j], carry);
+            }
+            uint64_t c = 0;
+            tp[n] = BigInt::add_carry(tp[n], carry, c);
+            tp[n + 1] = c;
+
+            // Add q * m with q chosen so the low limb cancels, then drop that limb
+            uint64_t q = tp[0] * m_inv;
+            carry = 0;
+            BigInt::mul_add(q, m[0], tp[0], carry);
+            for (size_t j = 1; j < n; ++j) {
+                tp[j - 1] = BigInt::mul_add(q, m[j], tp[j], carry);
+            }
+            c = 0;
+            tp[n - 1] = BigInt::add_carry(tp[n], carry, c);
+            tp[n] = tp[n + 1] + c;
+        }
+
+        // t < 2n: one conditional subtraction brings it into [0, n)
+        if (tp[n] != 0 || !less_than_modulus(tp)) {
+            BigInt::sub_in_place(tp, n + 1, m, n);
+        }
+        std::copy(tp, tp + n, r);
+    }
+
+    /**
+     * @brief The same product as mul(), with the work split over `tasks`
+     * threads of WorkPool::shared(). CIOS interleaves the reduction into every
+     * row, so this uses separated operand scanning instead: T = a * b, then
+     * q = T * (-n^-1) mod R and r = (T + q * n) / R. Each of the three products
+     * is cut into row blocks that run as tasks and are summed afterwards.
+     */
+    void mul_parallel(const uint64_t* a, const uint64_t* b, uint64_t* r, size_t tasks) {
+        if (m_prime.empty()) derive_m_prime();
+        size_t block = (n + tasks - 1) / tasks;
+        if (partials.size() < tasks * (n + block)) partials.resize(tasks * (n + block));
+        if (wide.size() < 2 * n + 1) {
+            wide.resize(2 * n + 1);
+            low.resize(n);
+            qm.resize(2 * n);
+        }
+        BIGINT_COUNT(STAT_LIMB_MULS, 2 * n * n + n * (n + 1) / 2);
+
+        product_rows(a, b, wide.data(), 2 * n, tasks);
+        wide[2 * n] = 0;
+        product_rows(wide.data(), m_prime.data(), low.data(), n, tasks);
+        product_rows(low.data(), mod.limbs.data(), qm.data(), 2 * n, tasks);
+        BigInt::add_in_place(wide.data(), 2 * n + 1, qm.data(), 2 * n);
+
+        // The low half is now zero; (T + q n) / R < 2n
+        uint64_t* tp = wide.data() + n;
+        if (tp[n] != 0 || !less_than_modulus(tp)) {
+            BigInt::sub_in_place(tp, n + 1, mod.limbs.data(), n);
+        }
+        std::copy(tp, tp + n, r);
+    }
+
+    // out = x * R mod n for 0 <= x < n
+    void to_montgomery(const BigInt& x, uint64_t* out) {
+        std::fill(padded.begin(), padded.end(), 0);
+        std::copy(x.limbs.begin(), x.limbs.end(), padded.begin());
+        mul(padded.data(), r2.data(), out);
+    }
+
+    // out = a * R^-1 mod n, the ordinary value of a Montgomery-form a
+    void from_montgomery(const uint64_t* a, BigInt& out) {
+        std::fill(padded.begin(), padded.end(), 0);
+        padded[0] = 1;
+        out.limbs.resize(n);
+        out.neg = false;
+        mul(a, padded.data(), out.limbs.data());
+        out.normalize();
+    }
+
+    /**
+     * @brief out = base^exp mod n, in Montgomery form, for 0 <= base < n.
+     * Fixed-window exponentiation: the exponent is consumed `window` bits at a
+     * time from the top, each window costing `window` squarings and at most one
+     * multiplication by a precomputed power base^0 .. base^(2^window - 1).
+     * The powers are kept, so a following call with the same base (a repeated
+     * (x, n) pair) skips building them.
+     */
+    void pow_montgomery(const BigInt& base, const BigInt& exp, uint64_t* out) {
+        size_t bits = exp.neg ? 0 : exp.bit_length();
+        if (bits == 0) {
+            std::copy(one_m.begin(), one_m.end(), out);
+            return;
+        }
+        unsigned window = bits > 512 ? 5 : bits > 128 ? 4 : bits > 32 ? 3 : 1;
+        size_t entries = size_t(1) << window;
+        if (table.size() < entries * n) table.resize(entries * n);
+
+        // Row blocks of at least 8 limbs, one per pool thread plus this one
+        size_t workers = parallel_limbs > 0 && n >= parallel_limbs ? WorkPool::shared().workers() : 0;
+        size_t tasks = std::min(workers + 1, std::max<size_t>(1, n / 8));
+        auto step = [&](const uint64_t* x, const uint64_t* y, uint64_t* r) {
+            if (tasks > 1) mul_parallel(x, y, r, tasks);
+            else mul(x, y, r);
+        };
+
+        uint64_t* tab = table.data();
+        if (table_entries == 0 || base != table_base) {
+            std::copy(one_m.begin(), one_m.end(), tab);
+            to_montgomery(base, tab + n);
+            table_base = base;
+            table_entries = 2;
+        }
+        for (size_t i = table_entries; i < entries; ++i) step(tab + (i - 1) * n, tab + n, tab + i * n);
+        table_entries = std::max(table_entries, entries);
+
+        size_t windows = (bits + window - 1) / window;
+        for (size_t w = windows; w-- > 0;) {
+            uint64_t digit = exp_bits(exp, w * window, window);
+            if (w + 1 == windows) {
+                std::copy(tab + digit * n, tab + (digit + 1) * n, out);
+                continue;
+            }
+            for (unsigned s = 0; s < window; ++s) step(out, out, out);
+            if (digit != 0) step(out, tab + digit * n, out);
+        }
+    }
+
+    // out = base^exp mod n for 0 <= base < n
+    void pow(const BigInt& base, const BigInt& exp, BigInt& out) {
+        pow_montgomery(base, exp, acc.data());
+        from_montgomery(acc.data(), out);
+    }
+
+private:
+    bool less_than_modulus(const uint64_t* a) const {
+        const uint64_t* m = mod.limbs.data();
+        for (size_t i = n; i-- > 0;) {
+            if (a[i] != m[i]) return a[i] < m[i];
+        }
+        return false;
+    }
+
+    // out[0..limit) = (x * y) mod B^limit for n-limb x and y. Task k multiplies
+    // rows [k * block, (k + 1) * block) of x into its own partial buffer; the
+    // partials are then added at their row offsets.
+    void product_rows(const uint64_t* x, const uint64_t* y, uint64_t* out, size_t limit, size_t tasks) {
+        size_t block = (n + tasks - 1) / tasks;
+        size_t stride = n + block;
+        auto rows = [this, x, y, out, limit, block, stride](size_t k) {
+            size_t lo = k * block, hi = std::min(n, lo + block);
+            if (lo >= std::min(hi, limit)) return;
+            uint64_t* p = partials.data() + k * stride;
+            size_t len = std::min(hi - lo + n, limit - lo);
+            std::fill(p, p + len, 0);
+            for (size_t i = lo; i < hi && i < limit; ++i) {
+                uint64_t carry = 0;
+                size_t off = i - lo;
+                size_t cols = std::min(n, len - off);
+                for (size_t j = 0; j < cols; ++j) p[off + j] = BigInt::mul_add(x[i], y[j], p[off + j], carry);
+                if (off + n < len) p[off + n] = carry;
+            }
+        };
+
+        {
+            TaskGroup group;
+            for (size_t k = 1; k < tasks; ++k) group.run([&rows, k] { rows(k); });
+            rows(0);
+            group.wait();
+        }
+
+        std::fill(out, out + limit, 0);
+        for (size_t k = 0; k < tasks; ++k) {
+            size_t lo = k * block;
+            if (lo >= std::min(n, limit)) break;
+            size_t len = std::min(std::min(n, lo + block) - lo + n, limit - lo);
+            BigInt::add_in_place(out + lo, limit - lo, partials.data() + k * stride, len);
+        }
+    }
+
+    // m_prime = -n^-1 mod R by Newton's iteration on BigInt, doubling the
+    // correct limbs each step from the one-limb inverse
+    void derive_m_prime() {
+        BigInt x;
+        x.limbs.assign(1, ~m_inv + 1); // n^-1 mod 2^64
+        for (size_t limbs = 1; limbs < n;) {
+            limbs = std::min(2 * limbs, n);
+            BigInt nx = mod * x;
+            LimbVector correction(limbs, 0), low_nx(limbs, 0);
+            correction[0] = 2;
+            std::copy(nx.limbs.begin(), nx.limbs.begin() + std::min(nx.limbs.size(), limbs), low_nx.begin());
+            mod_sub(correction.data(), low_nx.data(), limbs); // 2 - n x
+            BigInt c;
+            c.limbs = correction;
+            c.normalize();
+            x = x * c;
+            truncate(x, limbs);
+        }
+        m_prime.assign(n, 0);
+        LimbVector x_limbs(n, 0);
+        std::copy(x.limbs.begin(), x.limbs.begin() + std::min(x.limbs.size(), n), x_limbs.begin());
+        mod_sub(m_prime.data(), x_limbs.data(), n);
+    }
+
+    // Keeps the low `limbs` limbs of x
+    static void truncate(BigInt& x, size_t limbs) {
+        if (x.limbs.size() > limbs) x.limbs.resize(limbs);
+        x.normalize();
+    }
+
+    // a = (a - b) mod B^len
+    static void mod_sub(uint64_t* a, const uint64_t* b, size_t len) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < len; ++i) {
+            uint64_t diff = a[i] - b[i];
+            uint64_t b1 = a[i] < b[i];
+            a[i] = diff - borrow;
+            borrow = b1 | (diff < borrow);
+        }
+    }
+
+    // `count` bits of exp starting at bit `pos`
+    static uint64_t exp_bits(const BigInt& exp, size_t pos, unsigned count) {
+        uint64_t value = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            size_t bit = pos + i;
+            size_t limb = bit / 64;
+            if (limb < exp.limbs.size() && ((exp.limbs[limb] >> (bit % 64)) & 1)) value |= uint64_t(1) << i;
+        }
+        return value;
+    }
+
+    BigInt mod;
+    size_t n = 0;
+    uint64_t m_inv = 0;
+    LimbVector t, padded, r2, one_m, minus_one_m, acc, table;
+    BigInt table_base;          // the base whose powers table holds
+    size_t table_entries = 0;   // how many of them
+    LimbVector m_prime, partials, wide, low, qm;  // parallel path only
+};
+
+#endif // MONTGOMERY_H
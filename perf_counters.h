@@ -0,0 +1,126 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// Hardware performance counters of the calling thread through the raw
+// perf_event_open syscall, so no perf tool or library is needed. Each event is
+// opened on its own: events the CPU, the hypervisor or perf_event_paranoid
+// refuse are reported as unavailable and the rest still count.
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_STALLED_FRONTEND,
+    PERF_STALLED_BACKEND,
+    PERF_PAGE_FAULTS,
+    PERF_EVENT_COUNT
+};
+
+static const char* const perf_event_names[PERF_EVENT_COUNT] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses",
+    "stalled_cycles_frontend", "stalled_cycles_backend", "page_faults",
+};
+
+/**
+ * @brief Counts of one measured region; available[i] is false for events that
+ * could not be opened. Values are scaled up when the kernel multiplexed an event.
+ */
+struct PerfSample {
+    double values[PERF_EVENT_COUNT] = {};
+    bool available[PERF_EVENT_COUNT] = {};
+};
+
+/**
+ * @brief The counter set: enable with start(), read with stop().
+ */
+class PerfCounters {
+public:
+    PerfCounters() {
+        const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint64_t ll_read_miss = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const struct { uint32_t type; uint64_t config; } events[PERF_EVENT_COUNT] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, l1d_read_miss},
+            {PERF_TYPE_HW_CACHE, ll_read_miss},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        };
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds[i] < 0 && first_error.empty()) {
+                first_error = std::string(perf_event_names[i]) + ": " + std::strerror(errno);
+            }
+        }
+    }
+
+    ~PerfCounters() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Whether any hardware event (everything but page faults) opened
+    bool has_hardware() const {
+        for (size_t i = 0; i < PERF_PAGE_FAULTS; ++i) {
+            if (fds[i] >= 0) return true;
+        }
+        return false;
+    }
+
+    // Why the first unavailable event failed, or empty when all opened
+    const std::string& error() const { return first_error; }
+
+    void start() {
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    PerfSample stop() {
+        PerfSample sample;
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            if (fds[i] < 0) continue;
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t data[3]; // value, time enabled, time running
+            if (read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+            sample.available[i] = true;
+            sample.values[i] = data[2] > 0 ? static_cast<double>(data[0]) * data[1] / data[2] : 0;
+        }
+        return sample;
+    }
+
+private:
+    int fds[PERF_EVENT_COUNT];
+    std::string first_error;
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,394 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+// C++20 coroutine pipeline: stages are coroutines running on per-stage
+// executors and connected by bounded lock-free channels. A stage that finds
+// its input empty or its output full suspends instead of blocking its thread,
+// so an executor shared by several cheap stages keeps running the others.
+
+#include <coroutine>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iostream>
+#include <exception>
+
+/**
+ * @brief Fixed pool of threads that resume posted coroutine handles.
+ */
+class Executor {
+public:
+    Executor(size_t threads, std::string name) : name(std::move(name)) {
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(handle);
+        }
+        ready.notify_one();
+    }
+
+    // The executor running the calling thread, if any
+    static Executor*& current() {
+        static thread_local Executor* executor = nullptr;
+        return executor;
+    }
+
+    const std::string name;
+
+private:
+    void run() {
+        current() = this;
+        while (true) {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                handle = queue.front();
+                queue.pop_front();
+            }
+            handle.resume();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::coroutine_handle<>> queue;
+    bool stopping = false;
+};
+
+/**
+ * @brief Bounded multi-producer multi-consumer ring (Vyukov's sequence-number
+ * design): push and pop are one CAS each and never take a lock.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t min_capacity) {
+        size_t capacity = 2;
+        while (capacity < min_capacity) capacity <<= 1;
+        mask = capacity - 1;
+        cells.reset(new Cell[capacity]);
+        for (size_t i = 0; i < capacity; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(T& value) {
+        Cell* cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false; // Full
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        Cell* cell;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false; // Empty
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    size_t approx_size() const {
+        size_t tail = enqueue_pos.load(std::memory_order_relaxed);
+        size_t head = dequeue_pos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) std::atomic<size_t> dequeue_pos{0};
+};
+
+/**
+ * @brief Backpressure counters of one stage.
+ */
+struct StageMetrics {
+    std::string name;
+    std::atomic<uint64_t> items{0};
+    std::atomic<uint64_t> busy_ns{0};      // time spent on items, excluding waits
+    std::atomic<uint64_t> starved{0};      // suspensions on an empty input
+    std::atomic<uint64_t> blocked{0};      // suspensions on a full output
+    std::atomic<uint64_t> max_out_depth{0};
+
+    explicit StageMetrics(std::string name) : name(std::move(name)) {}
+
+    void note_depth(size_t depth) {
+        uint64_t seen = max_out_depth.load(std::memory_order_relaxed);
+        while (depth > seen && !max_out_depth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+    }
+
+    void report(std::ostream& out) const {
+        out << "stage " << name << ": items=" << items.load()
+            << " busy_ms=" << busy_ns.load() / 1000000
+            << " starved=" << starved.load()
+            << " blocked=" << blocked.load()
+            << " max_out_depth=" << max_out_depth.load() << std::endl;
+    }
+};
+
+/**
+ * @brief Bounded channel between stages. The fast path is the lock-free queue;
+ * only a coroutine that has to park takes the waiter lock. Whoever makes room
+ * or adds an item hands it straight to a parked waiter and reposts that waiter
+ * on the executor it was running on.
+ */
+template <typename T>
+class Channel {
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        Executor* executor;
+        T* slot;     // pop: where to store the item; push: the item to push
+        bool* ok;
+    };
+
+public:
+    explicit Channel(size_t capacity) : queue(capacity) {}
+
+    struct PushAwaiter {
+        Channel& ch;
+        T value;
+        StageMetrics* metrics;
+        bool ok = true;
+
+        bool await_ready() {
+            if (!ch.queue.try_push(value)) return false;
+            ch.after_push();
+            return true;
+        }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(ch.waiter_mutex);
+            ch.push_waiting.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ch.queue.try_push(value)) {
+                ch.push_waiting.fetch_sub(1);
+                lock.unlock();
+                ch.after_push();
+                return false;
+            }
+            ch.push_waiters.push_back({handle, Executor::current(), &value, &ok});
+            if (metrics) metrics->blocked++;
+            return true;
+        }
+        void await_resume() {
+            if (metrics) metrics->note_depth(ch.queue.approx_size());
+        }
+    };
+
+    struct PopAwaiter {
+        Channel& ch;
+        T& out;
+        StageMetrics* metrics;
+        bool ok = true;
+
+        bool await_ready() {
+            if (!ch.queue.try_pop(out)) return false;
+            ch.after_pop();
+            return true;
+        }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(ch.waiter_mutex);
+            ch.pop_waiting.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ch.queue.try_pop(out)) {
+                ch.pop_waiting.fetch_sub(1);
+                lock.unlock();
+                ch.after_pop();
+                return false;
+            }
+            if (ch.closed.load()) {
+                ch.pop_waiting.fetch_sub(1);
+                ok = false;
+                return false;
+            }
+            ch.pop_waiters.push_back({handle, Executor::current(), &out, &ok});
+            if (metrics) metrics->starved++;
+            return true;
+        }
+        // False once the channel is closed and drained
+        bool await_resume() { return ok; }
+    };
+
+    PushAwaiter push(T value, StageMetrics* metrics = nullptr) { return PushAwaiter{*this, std::move(value), metrics}; }
+    PopAwaiter pop(T& out, StageMetrics* metrics = nullptr) { return PopAwaiter{*this, out, metrics}; }
+
+    // No more pushes; parked consumers finish once the queue is drained
+    void close() {
+        closed.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<Waiter> wake;
+        {
+            std::lock_guard<std::mutex> lock(waiter_mutex);
+            while (!pop_waiters.empty()) {
+                Waiter w = pop_waiters.front();
+                pop_waiters.pop_front();
+                pop_waiting.fetch_sub(1);
+                *w.ok = queue.try_pop(*w.slot);
+                wake.push_back(w);
+            }
+        }
+        for (auto& w : wake) w.executor->post(w.handle);
+    }
+
+private:
+    // A consumer may be parked: hand it queued items
+    void after_push() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pop_waiting.load() == 0) return;
+        std::vector<Waiter> wake;
+        {
+            std::lock_guard<std::mutex> lock(waiter_mutex);
+            while (!pop_waiters.empty() && queue.try_pop(*pop_waiters.front().slot)) {
+                wake.push_back(pop_waiters.front());
+                pop_waiters.pop_front();
+                pop_waiting.fetch_sub(1);
+            }
+        }
+        for (auto& w : wake) w.executor->post(w.handle);
+        if (!wake.empty()) after_pop();
+    }
+
+    // A producer may be parked: move its item into the freed room
+    void after_pop() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (push_waiting.load() == 0) return;
+        std::vector<Waiter> wake;
+        {
+            std::lock_guard<std::mutex> lock(waiter_mutex);
+            while (!push_waiters.empty() && queue.try_push(*push_waiters.front().slot)) {
+                wake.push_back(push_waiters.front());
+                push_waiters.pop_front();
+                push_waiting.fetch_sub(1);
+            }
+        }
+        for (auto& w : wake) w.executor->post(w.handle);
+        if (!wake.empty()) after_push();
+    }
+
+    BoundedQueue<T> queue;
+    std::atomic<bool> closed{false};
+    std::atomic<size_t> push_waiting{0}, pop_waiting{0};
+    std::mutex waiter_mutex;
+    std::deque<Waiter> push_waiters, pop_waiters;
+};
+
+/**
+ * @brief Fire-and-forget coroutine for one stage worker. It starts when
+ * posted to an executor and frees itself when it returns.
+ */
+struct StageTask {
+    struct promise_type {
+        StageTask get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    void start_on(Executor& executor) { executor.post(handle); }
+};
+
+/**
+ * @brief Counts running stage workers; the pipeline owner waits for zero.
+ * Each stage also learns when its last worker is done so it can close its
+ * output channel.
+ */
+class WaitGroup {
+public:
+    void add(size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        count += n;
+    }
+    // Returns true for the caller that brought the count to zero
+    bool done() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--count == 0) {
+            zero.notify_all();
+            return true;
+        }
+        return false;
+    }
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        zero.wait(lock, [this] { return count == 0; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable zero;
+    size_t count = 0;
+};
+
+/**
+ * @brief Measures the busy time of one item for a stage's metrics.
+ */
+class BusyTimer {
+public:
+    explicit BusyTimer(StageMetrics& metrics) : metrics(metrics), start(std::chrono::steady_clock::now()) {}
+    ~BusyTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        metrics.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        metrics.items++;
+    }
+
+private:
+    StageMetrics& metrics;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // PIPELINE_H
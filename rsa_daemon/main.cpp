@@ -0,0 +1,381 @@
+#include "../solvers.h"
+#include "../trace.h"
+#include "../job_scheduler.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <iterator>
+#include <csignal>
+#include <pthread.h>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Local modexp / primality / inverse daemon on a Unix-domain socket.
+//
+// Every request and reply is one frame: a 4-byte little-endian payload length
+// followed by the payload. Request payloads are text in the drivers' reversed-hex
+// format, prefixed by a client-chosen id:
+//     <id> powmod <n> <k> <x>      -> <id> <x^k mod n>
+//     <id> isprime <n>             -> <id> 1|0
+//     <id> inverse <a> <m>         -> <id> <a^-1 mod m> | <id> -1
+// Replies are sent as soon as they are ready, so they may come back out of order.
+// A request that fails answers "<id> ERR <reason>".
+// --record <file> writes every request to a trace that trace_replay can re-run.
+// Requests are queued in cost lanes (see job_scheduler.h), so a burst of small
+// requests is not held up behind a few large ones: --lane-weights and
+// --max-wait-ms tune the lanes.
+// --window-us N holds a batch open for up to N microseconds so more requests
+// are queued with it under one lock (0, the default, adds no delay).
+
+static const size_t max_frame_bytes = 1 << 20;
+static const size_t max_batch_requests = 256;
+static std::atomic<bool> stop_requested(false);
+
+struct Request {
+    uint64_t conn_id;
+    std::string payload;
+};
+
+struct Reply {
+    uint64_t conn_id;
+    std::string payload;
+};
+
+struct Connection {
+    int fd;
+    std::string in;   // bytes received, not yet framed
+    std::string out;  // framed replies, not yet sent
+    size_t in_flight = 0;      // requests framed but not yet answered
+    bool read_closed = false;  // the client has shut down its side
+};
+
+// The estimated cost of a request payload "<id> <op> <operands...>"
+static double request_cost(const std::string& payload) {
+    size_t op_start = payload.find_first_not_of(' ', payload.find(' '));
+    if (op_start == std::string::npos) return 0;
+    size_t op_end = std::min(payload.find(' ', op_start), payload.size());
+    std::string_view operands(payload);
+    operands.remove_prefix(op_end);
+    return estimate_request_cost(payload.substr(op_start, op_end - op_start), operands);
+}
+
+/**
+ * @brief Worker pool that takes coalesced batches, queues their requests in
+ * cost lanes and hands replies back to the event loop through a self-pipe.
+ * Requests stay separate jobs so every worker can take them; a worker's
+ * per-thread Montgomery context already skips the setup for a modulus it saw
+ * last, so requests for one key need no grouping.
+ */
+class BatchWorkers {
+public:
+    BatchWorkers(size_t count, int wake_fd, const SchedulerConfig& schedule)
+        : wake_fd(wake_fd), queue(schedule) {
+        for (size_t i = 0; i < count; ++i) {
+            threads.emplace_back([this] { work(); });
+        }
+    }
+
+    ~BatchWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    // Queues every request of a batch under one lock
+    void submit(std::vector<Request>& batch) {
+        std::vector<double> costs;
+        costs.reserve(batch.size());
+        for (const auto& request : batch) costs.push_back(request_cost(request.payload));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < batch.size(); ++i) queue.push(std::move(batch[i]), costs[i], now);
+        }
+        batch.clear();
+        ready.notify_all();
+    }
+
+    std::vector<Reply> take_replies() {
+        std::lock_guard<std::mutex> lock(reply_mutex);
+        std::vector<Reply> taken;
+        taken.swap(replies);
+        return taken;
+    }
+
+private:
+    // One request at a time, so every pick goes through the lanes
+    void work() {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (!queue.pop(request)) return;
+            }
+
+            Reply reply{request.conn_id, process_daemon_request(request.payload)};
+            bool first;
+            {
+                std::lock_guard<std::mutex> lock(reply_mutex);
+                first = replies.empty();
+                replies.push_back(std::move(reply));
+            }
+            // Replies already waiting mean a wake-up is already pending, as does a full pipe
+            if (first) {
+                char byte = 1;
+                ssize_t ignored = write(wake_fd, &byte, 1);
+                (void)ignored;
+            }
+        }
+    }
+
+    int wake_fd;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable ready;
+    LaneScheduler<Request> queue;
+    bool stopping = false;
+
+    std::mutex reply_mutex;
+    std::vector<Reply> replies;
+};
+
+static void append_frame(std::string& out, const std::string& payload) {
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((len >> (8 * i)) & 0xFF));
+    out += payload;
+}
+
+// Moves every complete frame of conn.in into batch. Returns false on a malformed frame.
+static bool extract_frames(uint64_t conn_id, Connection& conn, std::vector<Request>& batch) {
+    size_t pos = 0;
+    while (conn.in.size() - pos >= 4) {
+        uint32_t len = 0;
+        for (int i = 0; i < 4; ++i) len |= static_cast<uint32_t>(static_cast<unsigned char>(conn.in[pos + i])) << (8 * i);
+        if (len > max_frame_bytes) return false;
+        if (conn.in.size() - pos - 4 < len) break;
+        batch.push_back({conn_id, conn.in.substr(pos + 4, len)});
+        pos += 4 + len;
+    }
+    conn.in.erase(0, pos);
+    return true;
+}
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void handle_stop_signal(int) {
+    stop_requested = true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << (argc > 0 ? argv[0] : "program") << " <socket_path> [--workers N] [--window-us N]"
+                  << " [--record <file> [--record-hashes]] [--lane-weights <small,medium,large>] [--max-wait-ms N]" << std::endl;
+        return 1;
+    }
+
+    std::string socket_path = argv[1];
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    // How long the first request of a batch waits for company. Requests run as
+    // separate lane jobs, so waiting groups nothing and only adds latency: by
+    // default a batch is whatever one poll pass has read.
+    long window_us = 0;
+    std::string record_path;
+    bool record_hashes = false;
+    SchedulerConfig schedule;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        bool has_value = i + 1 < argc;
+        if (flag == "--workers" && has_value) workers = std::max(1, std::atoi(argv[++i]));
+        else if (flag == "--window-us" && has_value) window_us = std::max(0, std::atoi(argv[++i]));
+        else if (flag == "--record" && has_value) record_path = argv[++i];
+        else if (flag == "--record-hashes") record_hashes = true;
+        else if (flag == "--max-wait-ms" && has_value) schedule.max_wait = std::chrono::milliseconds(std::max(0, std::atoi(argv[++i])));
+        else if (flag == "--lane-weights" && has_value) {
+            if (!parse_lane_weights(argv[++i], schedule)) {
+                std::cerr << "Lane weights must be three positive integers: small,medium,large" << std::endl;
+                return 1;
+            }
+        }
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Requests are recorded as they are framed, without their client ids
+    std::unique_ptr<TraceRecorder> recorder;
+    if (!record_path.empty()) {
+        try {
+            recorder = std::make_unique<TraceRecorder>(record_path, "daemon", record_hashes);
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << std::endl;
+            return 1;
+        }
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << socket_path << std::endl;
+        return 1;
+    }
+    std::strcpy(addr.sun_path, socket_path.c_str());
+    unlink(socket_path.c_str());
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+        std::cerr << "Cannot listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    set_nonblocking(listen_fd);
+
+    int wake_pipe[2];
+    if (pipe(wake_pipe) != 0) {
+        std::cerr << "Cannot create wake-up pipe: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    set_nonblocking(wake_pipe[0]);
+    set_nonblocking(wake_pipe[1]);
+
+    // SIGINT and SIGTERM stay blocked everywhere but inside ppoll, so they
+    // always land on the event loop and can never slip in between its
+    // stop_requested check and the wait. Threads inherit the mask.
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+    sigset_t stop_signals, wait_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &wait_mask);
+    sigdelset(&wait_mask, SIGINT);
+    sigdelset(&wait_mask, SIGTERM);
+
+    BatchWorkers pool(workers, wake_pipe[1], schedule);
+    std::unordered_map<uint64_t, Connection> connections;
+    uint64_t next_conn_id = 1;
+    std::vector<Request> batch;
+    auto batch_started = std::chrono::steady_clock::now();
+    std::vector<pollfd> fds;
+    std::vector<uint64_t> fd_conn;
+
+    std::cerr << "Listening on " << socket_path << " with " << workers << " workers" << std::endl;
+    while (!stop_requested) {
+        fds.clear();
+        fd_conn.clear();
+        fds.push_back({listen_fd, POLLIN, 0});
+        fds.push_back({wake_pipe[0], POLLIN, 0});
+        for (const auto& entry : connections) {
+            // A read-closed connection only waits for its replies
+            short events = entry.second.read_closed ? 0 : POLLIN;
+            if (!entry.second.out.empty()) events |= POLLOUT;
+            if (events == 0) continue;
+            fds.push_back({entry.second.fd, events, 0});
+            fd_conn.push_back(entry.first);
+        }
+
+        // An open batch bounds the wait by what is left of its window
+        timespec timeout;
+        timespec* timeout_ptr = nullptr;
+        if (!batch.empty()) {
+            long left_us = window_us - static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - batch_started).count());
+            if (left_us < 0) left_us = 0;
+            timeout = {left_us / 1000000, (left_us % 1000000) * 1000};
+            timeout_ptr = &timeout;
+        }
+        if (ppoll(fds.data(), fds.size(), timeout_ptr, &wait_mask) < 0 && errno != EINTR) {
+            std::cerr << "poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int client;
+            while ((client = accept(listen_fd, nullptr, nullptr)) >= 0) {
+                set_nonblocking(client);
+                connections[next_conn_id++] = Connection{client, "", ""};
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char drain[256];
+            while (read(wake_pipe[0], drain, sizeof(drain)) > 0) {}
+            for (auto& reply : pool.take_replies()) {
+                auto it = connections.find(reply.conn_id);
+                if (it == connections.end()) continue;
+                append_frame(it->second.out, reply.payload);
+                it->second.in_flight--;
+            }
+        }
+
+        for (size_t i = 2; i < fds.size(); ++i) {
+            auto it = connections.find(fd_conn[i - 2]);
+            if (it == connections.end()) continue;
+            Connection& conn = it->second;
+            bool closed = (fds[i].revents & (POLLERR | POLLNVAL)) != 0;
+
+            if (!closed && !conn.read_closed && (fds[i].revents & (POLLIN | POLLHUP))) {
+                char buf[65536];
+                ssize_t got;
+                while ((got = read(conn.fd, buf, sizeof(buf))) > 0) conn.in.append(buf, got);
+                if (got == 0) conn.read_closed = true; // Requests already sent still get their replies
+                else if (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK) closed = true;
+
+                if (batch.empty()) batch_started = std::chrono::steady_clock::now();
+                size_t framed = batch.size();
+                if (!extract_frames(it->first, conn, batch)) closed = true;
+                conn.in_flight += batch.size() - framed;
+                for (size_t r = framed; recorder && r < batch.size(); ++r) {
+                    std::istringstream fields(batch[r].payload);
+                    std::string id, op;
+                    fields >> id >> op;
+                    std::string operands((std::istreambuf_iterator<char>(fields)), std::istreambuf_iterator<char>());
+                    recorder->record(op, operands);
+                }
+            }
+
+            if (!closed && !conn.out.empty()) {
+                ssize_t sent = write(conn.fd, conn.out.data(), conn.out.size());
+                if (sent > 0) conn.out.erase(0, sent);
+                else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) closed = true;
+            }
+
+            if (closed || (conn.read_closed && conn.in_flight == 0 && conn.out.empty())) {
+                close(conn.fd);
+                connections.erase(it);
+            }
+        }
+
+        if (!batch.empty()) {
+            auto waited = std::chrono::steady_clock::now() - batch_started;
+            if (batch.size() >= max_batch_requests || waited >= std::chrono::microseconds(window_us)) {
+                pool.submit(batch);
+            }
+        }
+    }
+
+    for (auto& entry : connections) close(entry.second.fd);
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    return 0;
+}
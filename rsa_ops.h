@@ -0,0 +1,163 @@
+#ifndef RSA_OPS_H
+#define RSA_OPS_H
+
+#include "bigInt.h"
+#include "miller_rabin.h"
+
+// --- Bezout Algorithm ---
+BigInt bezout(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y) {
+    BigInt m0 = a, n0 = b;
+    BigInt x0 = BigInt(1), y0 = BigInt(0);
+    BigInt x1 = BigInt(0), y1 = BigInt(1);
+    while (n0 != BigInt(0)) {
+        BigInt q = m0 / n0;
+        BigInt r = m0 % n0;
+        BigInt xr = x0 - q * x1, yr = y0 - q * y1;
+        m0 = n0;
+        n0 = r;
+        x0 = x1;
+        y0 = y1;
+        x1 = xr;
+        y1 = yr;
+    }
+    x = x0;
+    y = y0;
+    return m0;
+}
+
+/**
+ * @brief Computes inv = a^-1 mod m, reduced into [0, m).
+ * Returns false when gcd(a, m) != 1 and no inverse exists.
+ */
+bool mod_inverse(const BigInt& a, const BigInt& m, BigInt& inv) {
+    BigInt x, y;
+    BigInt gcd = bezout(a, m, x, y);
+    if (gcd != BigInt(1)) return false;
+
+    inv = ((x % m) + m) % m; // Ensure x is positive
+    return true;
+}
+
+/**
+ * @brief Greatest common divisor of |a| and |b| (Euclid).
+ */
+BigInt gcd(BigInt a, BigInt b) {
+    a.set_positive();
+    b.set_positive();
+    while (!b.is_zero()) {
+        BigInt r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// Odd primes below 256, used to discard candidates before Miller-Rabin
+static const uint32_t small_odd_primes[] = {
+    3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97,
+    101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193,
+    197, 199, 211, 223, 227, 229, 233, 239, 241, 251
+};
+
+/**
+ * @brief Returns a random probable prime with exactly `bits` bits.
+ */
+BigInt generate_prime(size_t bits) {
+    if (bits < 2) {
+        throw std::invalid_argument("A prime needs at least 2 bits");
+    }
+    if (bits == 2) return random_bigint_in_range(BigInt(2), BigInt(3));
+
+    BigInt low = BigInt(1) << (bits - 1);
+    BigInt high = (BigInt(1) << bits) - BigInt(1);
+    while (true) {
+        BigInt candidate = random_bigint_in_range(low, high);
+        candidate.limbs[0] |= 1; // high is odd, so this stays in range
+
+        bool has_small_factor = false;
+        for (uint32_t p : small_odd_primes) {
+            if (candidate.mod_small(p) == 0) {
+                has_small_factor = (candidate != BigInt(p));
+                break;
+            }
+        }
+        if (has_small_factor) continue;
+
+        int k = 40; // Number of rounds for Miller-Rabin
+        if (is_prime_miller_rabin(candidate, k)) return candidate;
+    }
+}
+
+/**
+ * @brief Generates an RSA key: n = p * q has exactly `bits` bits and
+ * d = e^-1 mod (p - 1)(q - 1).
+ */
+void rsa_keygen(size_t bits, const BigInt& e, BigInt& p, BigInt& q, BigInt& d) {
+    if (bits < 8) {
+        throw std::invalid_argument("RSA modulus needs at least 8 bits");
+    }
+    BigInt one(1);
+    while (true) {
+        p = generate_prime(bits - bits / 2);
+        q = generate_prime(bits / 2);
+        if (p == q || (p * q).bit_length() != bits) continue;
+        if (mod_inverse(e, (p - one) * (q - one), d)) return;
+    }
+}
+
+/**
+ * @brief Finds a non-trivial factor of n: trial division by the small primes,
+ * then Pollard's rho with Brent's cycle detection.
+ * Returns false when n is 1 or probably prime.
+ */
+bool find_factor(const BigInt& n, BigInt& factor) {
+    BigInt one(1);
+    if (n <= one) return false;
+    if (n.is_even()) {
+        if (n == BigInt(2)) return false;
+        factor = BigInt(2);
+        return true;
+    }
+    for (uint32_t p : small_odd_primes) {
+        if (n.mod_small(p) == 0) {
+            if (n == BigInt(p)) return false;
+            factor = BigInt(p);
+            return true;
+        }
+    }
+    int k = 40; // Number of rounds for Miller-Rabin
+    if (is_prime_miller_rabin(n, k)) return false;
+
+    // Brent: products of |x - y| are accumulated and gcd'd once per block
+    const size_t block = 64;
+    for (int64_t c = 1; ; ++c) {
+        BigInt y = random_bigint_in_range(BigInt(2), n - one);
+        BigInt x, ys, g = one, prod = one;
+        BigInt cc(c);
+        for (size_t r = 1; g == one; r <<= 1) {
+            x = y;
+            for (size_t i = 0; i < r; ++i) y = (y * y + cc) % n;
+            for (size_t done = 0; done < r && g == one; done += block) {
+                ys = y;
+                for (size_t i = 0; i < std::min(block, r - done); ++i) {
+                    y = (y * y + cc) % n;
+                    prod = (prod * (x - y).abs()) % n;
+                }
+                g = gcd(prod, n);
+            }
+        }
+        if (g == n) {
+            // The block overshot: step one at a time from the saved point
+            do {
+                ys = (ys * ys + cc) % n;
+                g = gcd((x - ys).abs(), n);
+            } while (g == one);
+        }
+        if (g != n) {
+            factor = g;
+            return true;
+        }
+    }
+}
+
+#endif // RSA_OPS_H
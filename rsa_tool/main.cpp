@@ -0,0 +1,45 @@
+#include "../solvers.h"
+#include "../driver.h"
+#include <iostream>
+#include <string>
+
+// One binary for every operation. Each subcommand takes the driver modes:
+//     rsa_tool <subcommand> <input_file> <output_file>
+//     rsa_tool <subcommand> --batch <dir|manifest> [output_dir]
+//     rsa_tool <subcommand> --batch-async <dir|manifest> [output_dir]
+//     rsa_tool <subcommand> --stream
+//     rsa_tool <subcommand> --bulk <input_file> <output_file>   (isprime, inverse, powmod)
+
+struct Subcommand {
+    const char* name;
+    void (*solve)(std::istream&, std::ostream&);
+    const char* request;
+    FieldOp fields;
+};
+
+static const Subcommand subcommands[] = {
+    {"isprime", solve_isprime, "n",               {1, isprime_compute, "isprime"}},
+    {"inverse", solve_inverse, "p q e",           {3, inverse_compute, "inverse"}},
+    {"powmod",  solve_powmod,  "n k x",           {3, powmod_compute, "powmod", 0, 2}},
+    {"keygen",  solve_keygen,  "bits [e]",        {0, nullptr, "keygen"}},
+    {"factor",  solve_factor,  "n",               {0, nullptr, "factor"}},
+    {"bench",   solve_bench,   "bits iterations", {0, nullptr, "bench"}},
+};
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2) {
+        std::string name = argv[1];
+        for (const auto& sub : subcommands) {
+            if (name == sub.name) return driver_main(argc - 1, argv + 1, sub.solve, sub.fields);
+        }
+        std::cerr << "Unknown subcommand: " << name << std::endl;
+    }
+
+    std::cerr << "Usage: " << (argc > 0 ? argv[0] : "program") << " <subcommand> <input_file> <output_file>" << std::endl;
+    std::cerr << "       (or --batch / --batch-async <dir|manifest> [output_dir], --stream or --bulk <input_file> <output_file>, after the subcommand)" << std::endl;
+    std::cerr << "Subcommands (request fields):" << std::endl;
+    for (const auto& sub : subcommands) {
+        std::cerr << "    " << sub.name << " (" << sub.request << ")" << std::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,160 @@
+#include "../solvers.h"
+#include "../work_pool.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <stdexcept>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+// Runs every project_01_0X/test/*.inp in this process on a work-stealing pool
+// and diffs each answer against the matching .out (inputs without one are
+// listed as skipped):
+//     run_tests [repo_root] [--threads N] [--filter <substring>]
+// The largest inputs start first so one slow file does not end up alone at the
+// end of the run. Exits with status 1 when any file fails.
+
+namespace fs = std::filesystem;
+
+struct Project {
+    const char* dir;
+    void (*solve)(std::istream&, std::ostream&);
+};
+
+static const Project projects[] = {
+    {"project_01_01", solve_isprime},
+    {"project_01_02", solve_inverse},
+    {"project_01_03", solve_powmod},
+};
+
+struct TestCase {
+    fs::path input, expected;
+    uintmax_t bytes = 0;
+    const Project* project = nullptr;
+    bool passed = false;
+    std::string error;
+    double ms = 0;
+};
+
+// The answer without carriage returns and trailing whitespace
+static std::string normalize(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        if (c != '\r') out.push_back(c);
+    }
+    while (!out.empty() && std::isspace(static_cast<unsigned char>(out.back()))) out.pop_back();
+    return out;
+}
+
+static std::string read_file(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot read file: " + path.string());
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+static void run_case(TestCase& test) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        std::istringstream in(read_file(test.input));
+        std::ostringstream out;
+        test.project->solve(in, out);
+        test.passed = normalize(out.str()) == normalize(read_file(test.expected));
+        if (!test.passed) test.error = "output differs";
+    } catch (const std::exception& ex) {
+        test.error = ex.what();
+    }
+    test.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::string root = ".";
+    std::string filter;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--filter" && has_value) filter = argv[++i];
+        else if (!arg.empty() && arg[0] != '-') root = arg;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [repo_root] [--threads N] [--filter <substring>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<TestCase> tests;
+    std::vector<fs::path> skipped;
+    for (const auto& project : projects) {
+        fs::path dir = fs::path(root) / project.dir / "test";
+        if (!fs::is_directory(dir)) continue;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().extension() != ".inp") continue;
+            TestCase test;
+            test.input = entry.path();
+            test.expected = fs::path(entry.path()).replace_extension(".out");
+            if (!filter.empty() && test.input.string().find(filter) == std::string::npos) continue;
+            if (!fs::exists(test.expected)) {
+                skipped.push_back(test.input);
+                continue;
+            }
+            test.bytes = fs::file_size(test.input);
+            test.project = &project;
+            tests.push_back(test);
+        }
+    }
+    if (tests.empty()) {
+        std::cerr << "No test inputs found under " << root << std::endl;
+        return 1;
+    }
+    std::sort(tests.begin(), tests.end(), [](const TestCase& a, const TestCase& b) { return a.input < b.input; });
+
+    // One list, largest first; every thread takes the next file through a
+    // shared index, so the order holds however the pool schedules its tasks
+    std::vector<TestCase*> order;
+    for (auto& test : tests) order.push_back(&test);
+    std::stable_sort(order.begin(), order.end(), [](const TestCase* a, const TestCase* b) { return a->bytes > b->bytes; });
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::atomic<size_t> next(0);
+        auto drain = [&] {
+            for (size_t i; (i = next.fetch_add(1)) < order.size();) run_case(*order[i]);
+        };
+        WorkPool pool(threads - 1);
+        TaskGroup group(pool);
+        for (size_t t = 1; t < threads; ++t) group.run(drain);
+        drain(); // The main thread takes files too
+        group.wait();
+    }
+    double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t failed = 0;
+    double busy_ms = 0;
+    for (const auto& test : tests) {
+        char line[64];
+        std::snprintf(line, sizeof(line), "%s %9.3f ms  ", test.passed ? "PASS" : "FAIL", test.ms);
+        std::cout << line << test.input.string();
+        if (!test.passed) std::cout << "  (" << test.error << ")";
+        std::cout << '\n';
+        if (!test.passed) failed++;
+        busy_ms += test.ms;
+    }
+    std::sort(skipped.begin(), skipped.end());
+    for (const auto& path : skipped) std::cout << "SKIP              " << path.string() << "  (no .out)\n";
+    std::cout << (tests.size() - failed) << " passed, " << failed << " failed, " << skipped.size()
+              << " skipped in " << wall_ms
+              << " ms on " << threads << " threads (" << busy_ms << " ms of work)" << std::endl;
+    return failed ? 1 : 0;
+}
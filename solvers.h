@@ -0,0 +1,164 @@
+#ifndef SOLVERS_H
+#define SOLVERS_H
+
+#include "bigInt.h"
+#include "miller_rabin.h"
+#include "rsa_ops.h"
+#include "wiener.h"
+#include "driver.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <sstream>
+
+// One request -> one answer line, in the reversed-hex format of the project
+// input files. These are the Solver steps shared by the project drivers and
+// rsa_tool. The *_compute steps work on parsed values for bulk and pipeline modes.
+
+// isprime (project_01_01): reads n and writes 1 if it is probably prime, 0 otherwise.
+void isprime_compute(std::vector<BigInt>& values) {
+    int k = 40; // Number of rounds for Miller-Rabin
+    bool result = is_prime_miller_rabin(values[0], k);
+
+    values.assign(1, BigInt(result ? 1 : 0));
+}
+
+void solve_isprime(std::istream& in, std::ostream& out) {
+    solve_with_fields(in, out, {1, isprime_compute});
+}
+
+// inverse (project_01_02): reads p, q, e and writes d = e^-1 mod phi(n), or -1 when e has no inverse.
+void inverse_compute(std::vector<BigInt>& values) {
+    const BigInt& p = values[0];
+    const BigInt& q = values[1];
+    const BigInt& e = values[2];
+
+    BigInt one(BigInt(1));
+    BigInt phi = (p - one) * (q - one);
+
+    BigInt x;
+    if (!mod_inverse(e, phi, x)) {
+        values.clear();
+        return;
+    }
+
+    // Flag private exponents that the small-d attacks can recover
+    int severity = small_d_severity(p * q, x);
+    if (severity == 2) {
+        std::cerr << "Warning: d is below the Wiener bound n^0.25" << std::endl;
+    }
+    else if (severity == 1) {
+        std::cerr << "Warning: d is below the Boneh-Durfee bound n^0.292" << std::endl;
+    }
+    values.assign(1, x);
+}
+
+void solve_inverse(std::istream& in, std::ostream& out) {
+    solve_with_fields(in, out, {3, inverse_compute});
+}
+
+// powmod (project_01_03): reads n, k, x and writes x^k mod n.
+void powmod_compute(std::vector<BigInt>& values) {
+    BigInt result = powMod(values[2], values[1], values[0]);
+    values.assign(1, result);
+}
+
+void solve_powmod(std::istream& in, std::ostream& out) {
+    solve_with_fields(in, out, {3, powmod_compute});
+}
+
+// keygen: reads a decimal modulus size and an optional e (default 10001, i.e. 65537)
+// and writes "p q n d".
+void solve_keygen(std::istream& in, std::ostream& out) {
+    size_t bits = 0;
+    std::string e_str = "10001";
+    if (!(in >> bits)) {
+        throw std::runtime_error("keygen expects <bits> [e]");
+    }
+    in >> e_str;
+
+    BigInt p, q, d;
+    rsa_keygen(bits, BigInt::from_reversed_hex(e_str), p, q, d);
+    out << p.to_reversed_hex_string() << ' ' << q.to_reversed_hex_string() << ' '
+        << (p * q).to_reversed_hex_string() << ' ' << d.to_reversed_hex_string() << '\n';
+}
+
+// factor: reads n and writes "p q" with p <= q and p * q = n, or -1 when n is 1 or prime.
+void solve_factor(std::istream& in, std::ostream& out) {
+    std::string n_str;
+    in >> n_str;
+
+    BigInt n = BigInt::from_reversed_hex(n_str);
+    BigInt p;
+    if (!find_factor(n, p)) {
+        out << "-1" << '\n';
+        return;
+    }
+    BigInt q = n / p;
+    if (q < p) std::swap(p, q);
+    out << p.to_reversed_hex_string() << ' ' << q.to_reversed_hex_string() << '\n';
+}
+
+// bench: reads a decimal operand size and iteration count and writes the
+// mean nanoseconds per powmod, isprime and inverse call on random operands.
+void solve_bench(std::istream& in, std::ostream& out) {
+    size_t bits = 0, iterations = 0;
+    if (!(in >> bits >> iterations) || bits < 8 || iterations == 0) {
+        throw std::runtime_error("bench expects <bits >= 8> <iterations >= 1>");
+    }
+
+    BigInt low = BigInt(1) << (bits - 1);
+    BigInt high = (BigInt(1) << bits) - BigInt(1);
+    BigInt n = random_bigint_in_range(low, high);
+    n.limbs[0] |= 1;
+    BigInt k = random_bigint_in_range(low, high);
+    BigInt x = random_bigint_in_range(BigInt(2), n - BigInt(1));
+
+    auto time_ns = [&](auto&& op) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) op();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / static_cast<long long>(iterations);
+    };
+
+    BigInt sink;
+    long long powmod_ns = time_ns([&] { sink = powMod(x, k, n); });
+    long long isprime_ns = time_ns([&] { sink = BigInt(is_prime_miller_rabin(n, 1) ? 1 : 0); });
+    long long inverse_ns = time_ns([&] { mod_inverse(x, n, sink); });
+
+    out << "powmod=" << powmod_ns << "ns isprime=" << isprime_ns << "ns inverse=" << inverse_ns << "ns" << '\n';
+}
+
+// daemon: evaluates one rsa_daemon request payload "<id> <op> <operands...>"
+// and returns the reply payload (see rsa_daemon/main.cpp for the protocol).
+std::string process_daemon_request(const std::string& payload) {
+    std::istringstream fields(payload);
+    std::string id, op;
+    fields >> id >> op;
+
+    try {
+        if (op == "powmod") {
+            std::string n_str, k_str, x_str;
+            if (!(fields >> n_str >> k_str >> x_str)) throw std::runtime_error("powmod expects n k x");
+            return id + " " + powMod(BigInt::from_reversed_hex(x_str), BigInt::from_reversed_hex(k_str), BigInt::from_reversed_hex(n_str)).to_reversed_hex_string();
+        }
+        if (op == "isprime") {
+            std::string n_str;
+            if (!(fields >> n_str)) throw std::runtime_error("isprime expects n");
+            int k = 40; // Number of rounds for Miller-Rabin
+            return id + (is_prime_miller_rabin(BigInt::from_reversed_hex(n_str), k) ? " 1" : " 0");
+        }
+        if (op == "inverse") {
+            std::string a_str, m_str;
+            if (!(fields >> a_str >> m_str)) throw std::runtime_error("inverse expects a m");
+            BigInt inv;
+            if (!mod_inverse(BigInt::from_reversed_hex(a_str), BigInt::from_reversed_hex(m_str), inv)) return id + " -1";
+            return id + " " + inv.to_reversed_hex_string();
+        }
+        throw std::runtime_error("Unknown operation: " + op);
+    } catch (const std::exception& ex) {
+        return id + " ERR " + ex.what();
+    }
+}
+
+#endif // SOLVERS_H
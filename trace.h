@@ -0,0 +1,256 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Compact binary request traces, written by the drivers and the daemon with
+// --record and read back by trace_replay.
+//
+// File:   "RSATRACE" | u32 version | u8 length + source ("driver" or "daemon")
+// Record: u64 ns since the recording started | u8 length + operation name |
+//         u8 flags (bit 0: operands hashed) | u8 token count | tokens
+// Token:  u8 kind | u32 length in chars | kind 0: the chars (raw text)
+//                                        kind 1: hex digits packed two per byte
+//                                        kind 2: u64 FNV-1a hash of the chars
+// All integers are little-endian. Hashed traces keep the traffic shape
+// (operations, operand sizes, timing) without the operand values; tokens of
+// at most 16 chars (sizes, counts, small exponents) are kept as they are,
+// since a 64-bit hash would not hide them anyway.
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+static const char trace_magic[8] = {'R', 'S', 'A', 'T', 'R', 'A', 'C', 'E'};
+static const uint32_t trace_version = 1;
+static const uint8_t trace_flag_hashed = 1;
+static const size_t trace_max_plain_token = 16;
+
+enum TraceTokenKind : uint8_t {
+    TOKEN_RAW,
+    TOKEN_HEX,
+    TOKEN_HASHED
+};
+
+/**
+ * @brief One operand as recorded: its text, or only its length and hash.
+ */
+struct TraceToken {
+    TraceTokenKind kind = TOKEN_RAW;
+    uint32_t length = 0;
+    std::string text;   // empty for TOKEN_HASHED
+    uint64_t hash = 0;  // TOKEN_HASHED only
+};
+
+struct TraceRecord {
+    uint64_t time_ns = 0;
+    std::string op;
+    bool hashed = false;
+    std::vector<TraceToken> tokens;
+};
+
+uint64_t fnv1a_hash(std::string_view text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Appends records to a trace file. Safe to call from several threads.
+ */
+class TraceRecorder {
+public:
+    TraceRecorder(const std::string& path, const std::string& source, bool hashed)
+        : file(path, std::ios::binary), hashed(hashed), start(std::chrono::steady_clock::now()) {
+        if (!file) {
+            throw std::runtime_error("Cannot open file for writing: " + path);
+        }
+        std::string header(trace_magic, sizeof(trace_magic));
+        put_u32(header, trace_version);
+        header.push_back(static_cast<char>(source.size()));
+        header += source;
+        file.write(header.data(), header.size());
+    }
+
+    ~TraceRecorder() {
+        std::lock_guard<std::mutex> lock(mutex);
+        flush_locked();
+    }
+
+    // Records one request given its whitespace-separated text
+    void record(const std::string& op, std::string_view text) {
+        std::vector<std::string_view> tokens;
+        size_t pos = 0;
+        while (true) {
+            pos = text.find_first_not_of(" \t\r\n", pos);
+            if (pos == std::string_view::npos) break;
+            size_t end = text.find_first_of(" \t\r\n", pos);
+            if (end == std::string_view::npos) end = text.size();
+            tokens.push_back(text.substr(pos, end - pos));
+            pos = end;
+        }
+        record(op, tokens);
+    }
+
+    void record(const std::string& op, const std::vector<std::string_view>& tokens) {
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        std::string rec;
+        put_u64(rec, ns);
+        rec.push_back(static_cast<char>(std::min<size_t>(op.size(), 255)));
+        rec.append(op, 0, std::min<size_t>(op.size(), 255));
+        rec.push_back(static_cast<char>(hashed ? trace_flag_hashed : 0));
+        size_t count = std::min<size_t>(tokens.size(), 255);
+        rec.push_back(static_cast<char>(count));
+        for (size_t i = 0; i < count; ++i) {
+            std::string_view token = tokens[i];
+            if (hashed && token.size() > trace_max_plain_token) {
+                rec.push_back(static_cast<char>(TOKEN_HASHED));
+                put_u32(rec, static_cast<uint32_t>(token.size()));
+                put_u64(rec, fnv1a_hash(token));
+                continue;
+            }
+            bool hex = true;
+            for (char c : token) hex = hex && hex_value(c) >= 0;
+            rec.push_back(static_cast<char>(hex ? TOKEN_HEX : TOKEN_RAW));
+            put_u32(rec, static_cast<uint32_t>(token.size()));
+            if (!hex) {
+                rec.append(token.data(), token.size());
+                continue;
+            }
+            for (size_t j = 0; j < token.size(); j += 2) {
+                int lo = hex_value(token[j]);
+                int hi = j + 1 < token.size() ? hex_value(token[j + 1]) : 0;
+                rec.push_back(static_cast<char>(lo | (hi << 4)));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pending += rec;
+        if (pending.size() >= (1 << 16)) flush_locked();
+    }
+
+private:
+    static void put_u32(std::string& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+    static void put_u64(std::string& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void flush_locked() {
+        file.write(pending.data(), pending.size());
+        file.flush();
+        pending.clear();
+    }
+
+    std::ofstream file;
+    bool hashed;
+    std::chrono::steady_clock::time_point start;
+    std::mutex mutex;
+    std::string pending;
+};
+
+/**
+ * @brief Reads a trace written by TraceRecorder, one record at a time.
+ */
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path) : file(path, std::ios::binary) {
+        if (!file) {
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+        char magic[sizeof(trace_magic)];
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, trace_magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("Not a trace file: " + path);
+        }
+        if (get_u32() != trace_version) {
+            throw std::runtime_error("Unsupported trace version: " + path);
+        }
+        source = get_string(get_u8());
+    }
+
+    // The recording side: "driver" or "daemon"
+    const std::string& trace_source() const { return source; }
+
+    // False at the end of the trace
+    bool next(TraceRecord& rec) {
+        if (file.peek() == std::char_traits<char>::eof()) return false;
+        rec.time_ns = get_u64();
+        rec.op = get_string(get_u8());
+        rec.hashed = (get_u8() & trace_flag_hashed) != 0;
+        rec.tokens.assign(get_u8(), TraceToken());
+        for (TraceToken& token : rec.tokens) {
+            uint8_t kind = get_u8();
+            if (kind > TOKEN_HASHED) {
+                throw std::runtime_error("Bad trace token kind");
+            }
+            token.kind = static_cast<TraceTokenKind>(kind);
+            token.length = get_u32();
+            if (token.length > max_frame_chars) {
+                throw std::runtime_error("Oversized trace token");
+            }
+            if (token.kind == TOKEN_HASHED) {
+                token.hash = get_u64();
+            } else if (token.kind == TOKEN_RAW) {
+                token.text = get_string(token.length);
+            } else {
+                static const char digits[] = "0123456789ABCDEF";
+                std::string packed = get_string((token.length + 1) / 2);
+                token.text.assign(token.length, '0');
+                for (uint32_t j = 0; j < token.length && j / 2 < packed.size(); ++j) {
+                    unsigned char byte = static_cast<unsigned char>(packed[j / 2]);
+                    token.text[j] = digits[(j % 2 == 0) ? (byte & 0xF) : (byte >> 4)];
+                }
+            }
+        }
+        if (!file) {
+            throw std::runtime_error("Truncated trace record");
+        }
+        return true;
+    }
+
+private:
+    uint8_t get_u8() {
+        char c = 0;
+        file.read(&c, 1);
+        return static_cast<uint8_t>(c);
+    }
+    uint32_t get_u32() {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(get_u8()) << (8 * i);
+        return v;
+    }
+    uint64_t get_u64() {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(get_u8()) << (8 * i);
+        return v;
+    }
+    std::string get_string(size_t length) {
+        std::string s(length, '\0');
+        if (length > 0) file.read(&s[0], length);
+        return s;
+    }
+
+    static const uint32_t max_frame_chars = 1u << 28;
+
+    std::ifstream file;
+    std::string source;
+};
+
+#endif // TRACE_H
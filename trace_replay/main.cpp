@@ -0,0 +1,190 @@
+#include "../solvers.h"
+#include "../trace.h"
+#include "../latency_histogram.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+// Re-runs a request trace recorded with --record by a driver or rsa_daemon
+// against this build:
+//     trace_replay <trace_file> [--speed <factor>|max] [--out <file>] [--latency <file|->]
+// --speed 1 (the default) issues requests at their recorded pace, 2 twice as fast,
+// max (or 0) back to back. Latency is measured from when a request was due, not
+// from when it was issued, so a replay that falls behind shows the queueing it
+// caused instead of hiding it. --out writes one answer per line, to diff two
+// builds on the same trace. Hashed operands are replaced by pseudo-random
+// operands of the recorded size, seeded by their hash, so the same trace always
+// replays the same inputs.
+
+struct ReplaySolver {
+    const char* name;
+    void (*solve)(std::istream&, std::ostream&);
+};
+
+static const ReplaySolver replay_solvers[] = {
+    {"isprime", solve_isprime},
+    {"inverse", solve_inverse},
+    {"powmod",  solve_powmod},
+    {"keygen",  solve_keygen},
+    {"factor",  solve_factor},
+    {"bench",   solve_bench},
+};
+
+// A stand-in for a hashed token: same length, odd, no leading zero digit
+static std::string synthesize_token(const TraceToken& token) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string text(token.length, '0');
+    uint64_t state = token.hash;
+    for (uint32_t i = 0; i < token.length; ++i) {
+        // splitmix64
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        text[i] = digits[(z ^ (z >> 31)) & 0xF];
+    }
+    if (token.length > 0) {
+        text[0] = digits[hex_value(text[0]) | 1];
+        if (text.back() == '0') text.back() = '1';
+    }
+    return text;
+}
+
+/**
+ * @brief Evaluates one record the way its recording side would have and
+ * returns the answer line without its newline.
+ */
+static std::string replay_record(const std::string& source, const TraceRecord& rec, uint64_t seq) {
+    std::string text;
+    for (const TraceToken& token : rec.tokens) {
+        if (!text.empty()) text += ' ';
+        text += token.kind == TOKEN_HASHED ? synthesize_token(token) : token.text;
+    }
+
+    if (source == "daemon") {
+        return process_daemon_request(std::to_string(seq) + " " + rec.op + " " + text);
+    }
+
+    for (const auto& solver : replay_solvers) {
+        if (rec.op != solver.name) continue;
+        std::istringstream in(text);
+        std::ostringstream out;
+        try {
+            solver.solve(in, out);
+        } catch (const std::exception& ex) {
+            return std::string("ERR ") + ex.what();
+        }
+        std::string answer = out.str();
+        while (!answer.empty() && (answer.back() == '\n' || answer.back() == '\r')) answer.pop_back();
+        return answer;
+    }
+    return "ERR Unknown operation: " + rec.op;
+}
+
+// Operand size of a record: its largest hex operand
+static size_t record_bits(const TraceRecord& rec) {
+    size_t bits = 0;
+    for (const TraceToken& token : rec.tokens) {
+        if (token.kind != TOKEN_RAW) bits = std::max<size_t>(bits, 4 * static_cast<size_t>(token.length));
+    }
+    return bits;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << (argc > 0 ? argv[0] : "program")
+                  << " <trace_file> [--speed <factor>|max] [--out <file>] [--latency <file|->]" << std::endl;
+        return 1;
+    }
+
+    std::string trace_path = argv[1];
+    double speed = 1;
+    std::string out_path, latency_path;
+    for (int i = 2; i < argc; ++i) {
+        std::string flag = argv[i];
+        bool has_value = i + 1 < argc;
+        if (flag == "--speed" && has_value) {
+            std::string value = argv[++i];
+            speed = value == "max" ? 0 : std::atof(value.c_str());
+        }
+        else if (flag == "--out" && has_value) out_path = argv[++i];
+        else if (flag == "--latency" && has_value) latency_path = argv[++i];
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+    if (speed < 0) {
+        std::cerr << "--speed must be a positive factor or max" << std::endl;
+        return 1;
+    }
+
+    std::ofstream out_file;
+    if (!out_path.empty()) {
+        out_file.open(out_path);
+        if (!out_file) {
+            std::cerr << "Cannot open file for writing: " << out_path << std::endl;
+            return 1;
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    StageLatencies latencies;
+    std::map<std::string, LatencyHistogram> per_op;
+    uint64_t requests = 0, errors = 0;
+    clock::duration max_lag = clock::duration::zero();
+    auto start = clock::now();
+
+    try {
+        std::unique_ptr<LatencyExporter> exporter;
+        if (!latency_path.empty()) exporter = std::make_unique<LatencyExporter>(latencies, latency_path, 0);
+
+        TraceReader reader(trace_path);
+        const std::string& source = reader.trace_source();
+        TraceRecord rec;
+        while (reader.next(rec)) {
+            auto due = clock::now();
+            if (speed > 0) {
+                due = start + std::chrono::duration_cast<clock::duration>(std::chrono::nanoseconds(
+                    static_cast<uint64_t>(static_cast<double>(rec.time_ns) / speed)));
+                std::this_thread::sleep_until(due);
+                max_lag = std::max(max_lag, clock::now() - due);
+            }
+
+            std::string answer = replay_record(source, rec, requests);
+            auto elapsed = clock::now() - due;
+
+            per_op[rec.op].record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            latencies.record(STAGE_COMPUTE, rec.op, record_bits(rec), elapsed);
+            if (answer.compare(0, 4, "ERR ") == 0 || answer.find(" ERR ") != std::string::npos) errors++;
+            if (out_file) out_file << answer << '\n';
+            requests++;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    std::cerr << "Replayed " << requests << " requests in " << seconds << " s ("
+              << (seconds > 0 ? requests / seconds : 0) << " req/s), " << errors << " errors";
+    if (speed > 0) {
+        std::cerr << ", worst start lag " << std::chrono::duration<double, std::milli>(max_lag).count() << " ms";
+    }
+    std::cerr << std::endl;
+    for (const auto& entry : per_op) {
+        const LatencyHistogram& h = entry.second;
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-10s n=%-8llu p50=%.3f ms  p99=%.3f ms  max=%.3f ms",
+                      entry.first.c_str(), static_cast<unsigned long long>(h.count()),
+                      h.percentile(0.50) / 1e6, h.percentile(0.99) / 1e6, h.max() / 1e6);
+        std::cerr << line << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "../bigInt.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <ctime>
+#include <cstdlib>
+#include <unistd.h>
+
+// Measures on this machine the operand sizes at which bigInt.h should switch
+// from schoolbook to Karatsuba multiplication and squaring, in the spirit of
+// GMP's tuneup, and writes them as bigint_thresholds.h. bigInt.h includes that
+// header when it sits next to it, so the next build uses the tuned values.
+//
+//     tune [--out <file>] [--max-limbs N] [--min-time <seconds>]
+//
+// Run it from the repository root with --out bigint_thresholds.h; without
+// --out the header goes to stdout.
+//
+// For each size n it times one operation with the threshold above n (schoolbook
+// only) against the threshold at n (one Karatsuba split, schoolbook below it).
+// The threshold is the first size from which the split keeps winning.
+
+// Best of three runs of at least min_time seconds each, in ns per call
+static double time_ns(const std::function<void()>& op, double min_time) {
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        uint64_t iterations = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0;
+        do {
+            for (int i = 0; i < 16; ++i) op();
+            iterations += 16;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < min_time);
+        double ns = seconds * 1e9 / iterations;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+static BigInt random_limbs(size_t n, std::mt19937_64& gen) {
+    BigInt r;
+    r.limbs.resize(n);
+    for (auto& limb : r.limbs) limb = gen();
+    r.limbs.back() |= 1ULL << 63;
+    return r;
+}
+
+/**
+ * @brief Finds the smallest size from which one Karatsuba level beats the
+ * schoolbook loop for `wins_needed` consecutive sizes, or max_limbs if it never does.
+ */
+static size_t find_threshold(const std::string& name, size_t& threshold, bool square,
+                             size_t max_limbs, double min_time) {
+    const size_t wins_needed = 4;
+    std::mt19937_64 gen(20240917);
+    size_t first_win = 0, wins = 0;
+    BigInt sink;
+
+    for (size_t n = 4; n <= max_limbs; n = std::max(n + 1, n + n / 16)) {
+        BigInt a = random_limbs(n, gen), b = random_limbs(n, gen);
+        auto op = [&] { sink = square ? a * a : a * b; };
+
+        threshold = n + 1;
+        double basecase_ns = time_ns(op, min_time);
+        threshold = n;
+        double karatsuba_ns = time_ns(op, min_time);
+        std::cerr << name << " n=" << n << ": schoolbook " << basecase_ns << " ns, karatsuba " << karatsuba_ns << " ns" << std::endl;
+
+        if (karatsuba_ns < basecase_ns) {
+            if (wins++ == 0) first_win = n;
+            if (wins == wins_needed) return first_win;
+        } else {
+            wins = 0;
+        }
+    }
+    return max_limbs;
+}
+
+int main(int argc, char* argv[]) {
+    std::string out_path;
+    size_t max_limbs = 256;
+    double min_time = 0.01;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--out" && has_value) out_path = argv[++i];
+        else if (arg == "--max-limbs" && has_value) max_limbs = std::max<size_t>(8, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--min-time" && has_value) min_time = std::atof(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--out <file>] [--max-limbs N] [--min-time <seconds>]" << std::endl;
+            return 1;
+        }
+    }
+
+    size_t mul_threshold = find_threshold("mul", BigInt::karatsuba_mul_threshold, false, max_limbs, min_time);
+    BigInt::karatsuba_mul_threshold = mul_threshold;
+    size_t sqr_threshold = find_threshold("sqr", BigInt::karatsuba_sqr_threshold, true, max_limbs, min_time);
+    BigInt::karatsuba_sqr_threshold = sqr_threshold;
+
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+
+    std::ostringstream header;
+    header << "// Generated by tune on " << host << " at " << date << ". Do not edit;\n"
+           << "// re-run tune on the target machine instead.\n"
+           << "#ifndef BIGINT_THRESHOLDS_H\n"
+           << "#define BIGINT_THRESHOLDS_H\n\n"
+           << "#define BIGINT_KARATSUBA_MUL_THRESHOLD " << mul_threshold << "\n"
+           << "#define BIGINT_KARATSUBA_SQR_THRESHOLD " << sqr_threshold << "\n\n"
+           << "#endif // BIGINT_THRESHOLDS_H\n";
+
+    if (out_path.empty()) {
+        std::cout << header.str();
+        return 0;
+    }
+    std::ofstream file(out_path);
+    if (!file) {
+        std::cerr << "Cannot open file for writing: " << out_path << std::endl;
+        return 1;
+    }
+    file << header.str();
+    std::cerr << "Wrote " << out_path << ": mul " << mul_threshold << ", sqr " << sqr_threshold << " limbs" << std::endl;
+    return 0;
+}
@@ -0,0 +1,444 @@
+#ifndef URING_BATCH_H
+#define URING_BATCH_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#include "job_scheduler.h"
+
+/**
+ * @brief Minimal io_uring ring over the raw syscalls (no liburing needed).
+ * Only what the batch pipeline uses: get an SQE, submit, and reap CQEs.
+ */
+class IoUring {
+public:
+    ~IoUring() {
+        if (sqes) munmap(sqes, sqes_size);
+        if (cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+        if (sq_ptr) munmap(sq_ptr, sq_size);
+        if (ring_fd >= 0) close(ring_fd);
+    }
+
+    // Returns false when the kernel (or a sandbox) does not offer io_uring
+    bool init(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd < 0) return false;
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_size = cq_size = std::max(sq_size, cq_size);
+
+        sq_ptr = map(sq_size, IORING_OFF_SQ_RING);
+        cq_ptr = single_mmap ? sq_ptr : map(cq_size, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+        if (!sq_ptr || !cq_ptr || !sqes) return false;
+
+        char* sq = static_cast<char*>(sq_ptr);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries = params.sq_entries;
+        sq_local_tail = *sq_tail;
+
+        char* cq = static_cast<char*>(cq_ptr);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // A zeroed SQE to fill in, or nullptr when the submission ring is full
+    io_uring_sqe* get_sqe() {
+        unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (sq_local_tail - head >= sq_entries) return nullptr;
+        unsigned idx = sq_local_tail & sq_mask;
+        sq_array[idx] = idx;
+        sq_local_tail++;
+        std::memset(&sqes[idx], 0, sizeof(io_uring_sqe));
+        return &sqes[idx];
+    }
+
+    // Publishes the queued SQEs and waits for at least wait_nr completions.
+    // Entries the kernel has not consumed yet (after an EAGAIN or EBUSY) are
+    // submitted again by the next call.
+    int submit_and_wait(unsigned wait_nr) {
+        unsigned to_submit = sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+        int ret;
+        do {
+            ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, wait_nr,
+                                           wait_nr ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+        } while (ret < 0 && errno == EINTR);
+        return ret;
+    }
+
+    io_uring_cqe* peek_cqe() {
+        unsigned head = *cq_head;
+        if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) return nullptr;
+        return &cqes[head & cq_mask];
+    }
+
+    void cqe_seen() {
+        __atomic_store_n(cq_head, *cq_head + 1, __ATOMIC_RELEASE);
+    }
+
+private:
+    void* map(size_t size, off_t offset) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    int ring_fd = -1;
+    void* sq_ptr = nullptr;
+    void* cq_ptr = nullptr;
+    size_t sq_size = 0, cq_size = 0, sqes_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned *sq_head = nullptr, *sq_tail = nullptr, *sq_array = nullptr;
+    unsigned sq_mask = 0, sq_entries = 0, sq_local_tail = 0;
+    unsigned *cq_head = nullptr, *cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+/**
+ * @brief Fixed set of compute threads fed by index. Finished indices are
+ * queued back and announced on an eventfd so the I/O loop can wait on the
+ * ring alone.
+ */
+class ComputeWorkers {
+public:
+    ComputeWorkers(size_t count, std::function<void(size_t)> task, int done_fd)
+        : task(std::move(task)), done_fd(done_fd) {
+        for (size_t i = 0; i < count; ++i) {
+            threads.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ComputeWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    void submit(size_t index) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(index);
+        }
+        ready.notify_one();
+    }
+
+    std::vector<size_t> take_done() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<size_t> taken;
+        taken.swap(done);
+        return taken;
+    }
+
+private:
+    void work() {
+        while (true) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (pending.empty()) return;
+                index = pending.front();
+                pending.pop_front();
+            }
+            task(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.push_back(index);
+            }
+            uint64_t one = 1;
+            ssize_t ignored = write(done_fd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    std::function<void(size_t)> task;
+    int done_fd;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<size_t> pending;
+    std::vector<size_t> done;
+    bool stopping = false;
+};
+
+/**
+ * @brief Batch pipeline: one I/O thread drives open/read/write/close for up to
+ * max_in_flight files through io_uring while `workers` threads run the solver.
+ * Jobs are taken in the order of a lane scheduler over their estimated costs.
+ * Returns the number of failed jobs. When io_uring is unavailable the workers
+ * fall back to plain blocking file I/O.
+ */
+size_t run_batch_uring(const std::vector<std::pair<std::string, std::string>>& jobs,
+                       const std::function<void(std::istream&, std::ostream&)>& solve,
+                       size_t workers, size_t max_in_flight,
+                       const std::vector<double>& costs, const SchedulerConfig& schedule) {
+    enum Stage { Free, OpeningIn, Reading, Computing, OpeningOut, Writing, ClosingOut };
+    enum Tag : uint64_t { TagSlot = 0, TagCloseIn = 1, TagWake = 2 };
+
+    struct Slot {
+        Stage stage = Free;
+        size_t job = 0;
+        int fd = -1;
+        std::string data;   // file contents, then the answer
+        size_t done = 0;    // bytes read or written so far
+        bool failed = false;
+    };
+
+    const size_t read_chunk = 1 << 16;
+    std::vector<Slot> slots(max_in_flight);
+    size_t failed = 0;
+    LaneScheduler<size_t> order(schedule);
+    for (size_t j = 0; j < jobs.size(); ++j) order.push(j, costs[j]);
+
+    auto compute = [&](size_t s) {
+        Slot& slot = slots[s];
+        try {
+            std::istringstream in(slot.data);
+            std::ostringstream out;
+            solve(in, out);
+            slot.data = out.str();
+        } catch (const std::exception& ex) {
+            std::cerr << jobs[slot.job].first << ": " << ex.what() << std::endl;
+            slot.failed = true;
+        }
+    };
+
+    IoUring ring;
+    int wake_fd = eventfd(0, EFD_CLOEXEC);
+    // Declared before the compute pool, so its workers are joined before the
+    // eventfd they post to is closed
+    struct FdCloser {
+        int fd;
+        ~FdCloser() { if (fd >= 0) close(fd); }
+    } wake_closer{wake_fd};
+    if (wake_fd < 0 || !ring.init(static_cast<unsigned>(2 * max_in_flight + 2))) {
+        // No io_uring: every worker reads, solves and writes on its own
+        std::mutex mutex;
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < workers; ++w) {
+            threads.emplace_back([&] {
+                while (true) {
+                    size_t j;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!order.pop(j)) return;
+                    }
+                    std::ifstream file(jobs[j].first);
+                    std::ofstream outfile;
+                    if (file) outfile.open(jobs[j].second); // A missing input leaves its output alone
+                    bool ok = file && outfile;
+                    if (ok) {
+                        try {
+                            solve(file, outfile);
+                        } catch (const std::exception& ex) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            std::cerr << jobs[j].first << ": " << ex.what() << std::endl;
+                            ok = false;
+                        }
+                    }
+                    if (!ok) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!file) std::cerr << "Cannot read file: " << jobs[j].first << std::endl;
+                        else if (!outfile) std::cerr << "Cannot open file for writing: " << jobs[j].second << std::endl;
+                        failed++;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        return failed;
+    }
+
+    ComputeWorkers pool(workers, compute, wake_fd);
+    uint64_t wake_value = 0;
+    size_t active = 0;
+    size_t busy_retries = 0;
+
+    auto sqe_for = [&](uint64_t tag, size_t s) {
+        io_uring_sqe* sqe = ring.get_sqe(); // The ring holds two entries per slot, so this never fails
+        sqe->user_data = (tag << 32) | s;
+        return sqe;
+    };
+    auto arm_wake = [&] {
+        io_uring_sqe* sqe = sqe_for(TagWake, 0);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wake_fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&wake_value);
+        sqe->len = sizeof(wake_value);
+    };
+    auto submit_read = [&](size_t s) {
+        Slot& slot = slots[s];
+        if (slot.data.size() < slot.done + read_chunk) slot.data.resize(slot.done + read_chunk);
+        io_uring_sqe* sqe = sqe_for(TagSlot, s);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = slot.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&slot.data[slot.done]);
+        sqe->len = static_cast<uint32_t>(read_chunk);
+        sqe->off = slot.done;
+        slot.stage = Reading;
+    };
+    auto submit_write = [&](size_t s) {
+        Slot& slot = slots[s];
+        io_uring_sqe* sqe = sqe_for(TagSlot, s);
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = slot.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(slot.data.data() + slot.done);
+        sqe->len = static_cast<uint32_t>(slot.data.size() - slot.done);
+        sqe->off = slot.done;
+        slot.stage = Writing;
+    };
+    auto submit_open = [&](size_t s, const std::string& path, int flags, Stage stage) {
+        io_uring_sqe* sqe = sqe_for(TagSlot, s);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(path.c_str());
+        sqe->open_flags = static_cast<uint32_t>(flags | O_CLOEXEC);
+        sqe->len = 0644;
+        slots[s].stage = stage;
+    };
+    auto submit_close = [&](uint64_t tag, size_t s, int fd) {
+        io_uring_sqe* sqe = sqe_for(tag, s);
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = fd;
+    };
+    auto finish = [&](size_t s) {
+        if (slots[s].failed) failed++;
+        slots[s] = Slot();
+        active--;
+    };
+
+    arm_wake();
+    while (!order.empty() || active > 0) {
+        // Keep the in-flight window full
+        for (size_t s = 0; s < slots.size() && !order.empty(); ++s) {
+            if (slots[s].stage != Free) continue;
+            order.pop(slots[s].job);
+            active++;
+            submit_open(s, jobs[slots[s].job].first, O_RDONLY, OpeningIn);
+        }
+
+        if (ring.submit_and_wait(1) < 0) {
+            // EAGAIN and EBUSY clear once completions are reaped or memory frees up
+            if ((errno == EAGAIN || errno == EBUSY) && ++busy_retries < 1000) {
+                if (!ring.peek_cqe()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            } else {
+                std::cerr << "io_uring_enter failed: " << std::strerror(errno) << std::endl;
+                failed += active + order.size(); // Queued and in-flight files get no output
+                break;
+            }
+        } else {
+            busy_retries = 0;
+        }
+
+        io_uring_cqe* cqe;
+        while ((cqe = ring.peek_cqe()) != nullptr) {
+            uint64_t tag = cqe->user_data >> 32;
+            size_t s = static_cast<size_t>(cqe->user_data & 0xFFFFFFFFULL);
+            int res = cqe->res;
+            ring.cqe_seen();
+
+            if (tag == TagCloseIn) continue;
+            if (tag == TagWake) {
+                for (size_t done : pool.take_done()) {
+                    if (slots[done].failed) finish(done);
+                    else submit_open(done, jobs[slots[done].job].second, O_WRONLY | O_CREAT | O_TRUNC, OpeningOut);
+                }
+                arm_wake();
+                continue;
+            }
+
+            Slot& slot = slots[s];
+            switch (slot.stage) {
+            case OpeningIn:
+                if (res < 0) {
+                    std::cerr << "Cannot read file: " << jobs[slot.job].first << std::endl;
+                    slot.failed = true;
+                    finish(s);
+                    break;
+                }
+                slot.fd = res;
+                submit_read(s);
+                break;
+            case Reading:
+                if (res > 0) {
+                    slot.done += res;
+                    submit_read(s);
+                    break;
+                }
+                submit_close(TagCloseIn, s, slot.fd);
+                if (res < 0) {
+                    std::cerr << "Cannot read file: " << jobs[slot.job].first << std::endl;
+                    slot.failed = true;
+                    finish(s);
+                    break;
+                }
+                slot.data.resize(slot.done);
+                slot.done = 0;
+                slot.fd = -1;
+                slot.stage = Computing;
+                pool.submit(s);
+                break;
+            case OpeningOut:
+                if (res < 0) {
+                    std::cerr << "Cannot open file for writing: " << jobs[slot.job].second << std::endl;
+                    slot.failed = true;
+                    finish(s);
+                    break;
+                }
+                slot.fd = res;
+                submit_write(s);
+                break;
+            case Writing:
+                if (res > 0) slot.done += res;
+                if (res < 0) slot.failed = true;
+                if (res > 0 && slot.done < slot.data.size()) {
+                    submit_write(s);
+                    break;
+                }
+                submit_close(TagSlot, s, slot.fd);
+                slot.stage = ClosingOut;
+                break;
+            case ClosingOut:
+                finish(s);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return failed;
+}
+
+#endif // URING_BATCH_H
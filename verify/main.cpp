@@ -0,0 +1,220 @@
+#include "../bigInt.h"
+#include "../bigint_reference.h"
+#include "../montgomery.h"
+#include "../miller_rabin.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <functional>
+#include <cstdlib>
+
+// Differential test of the fast arithmetic paths against the frozen reference
+// in bigint_reference.h:
+//     verify [--iterations N] [--seed S] [--max-limbs L]
+// Every iteration draws operands of independent sizes and edge shapes (all-ones
+// limbs, carries and borrows that ripple across every limb, top bit set,
+// powers of two, sparse limbs), then checks +, -, *, squaring, divmod, shifts,
+// mod_small, Montgomery multiplication and exponentiation, and powMod. The
+// Karatsuba thresholds are cycled down to 4 limbs so deep recursion is covered
+// at modest sizes, and the parallel thresholds down so the forked Karatsuba
+// sub-products and the split Montgomery multiplications are too (run with
+// BIGINT_THREADS=4 to fork on a small machine). Any mismatch prints the operands in reversed hex and the run
+// exits with status 1.
+
+enum Shape {
+    SHAPE_RANDOM,
+    SHAPE_ALL_ONES,      // every limb 0xFF..FF
+    SHAPE_RIPPLE,        // all ones but the lowest limb: +1 carries through every limb
+    SHAPE_POWER_OF_TWO,  // a single set bit at the top
+    SHAPE_TOP_BIT,       // random limbs with the top bit set, like a normalized divisor
+    SHAPE_SPARSE,        // mostly zero limbs
+    SHAPE_ALTERNATING,   // zero and all-ones limbs in turn
+    SHAPE_COUNT
+};
+
+class OperandSource {
+public:
+    explicit OperandSource(uint64_t seed) : gen(seed) {}
+
+    uint64_t next() { return gen(); }
+    size_t below(size_t n) { return static_cast<size_t>(gen() % n); }
+
+    BigInt operand(size_t limbs, Shape shape) {
+        BigInt x;
+        x.limbs.assign(limbs, 0);
+        for (size_t i = 0; i < limbs; ++i) {
+            switch (shape) {
+                case SHAPE_ALL_ONES: x.limbs[i] = ~uint64_t(0); break;
+                case SHAPE_RIPPLE: x.limbs[i] = i == 0 ? ~uint64_t(0) - below(4) : ~uint64_t(0); break;
+                case SHAPE_POWER_OF_TWO: x.limbs[i] = 0; break;
+                case SHAPE_SPARSE: x.limbs[i] = below(8) == 0 ? gen() : 0; break;
+                case SHAPE_ALTERNATING: x.limbs[i] = (i % 2) ? ~uint64_t(0) : 0; break;
+                default: x.limbs[i] = gen(); break;
+            }
+        }
+        if (shape == SHAPE_POWER_OF_TWO) x.limbs[limbs - 1] = uint64_t(1) << 63;
+        if (shape == SHAPE_TOP_BIT || shape == SHAPE_ALTERNATING) x.limbs[limbs - 1] |= uint64_t(1) << 63;
+        x.normalize();
+        return x;
+    }
+
+    BigInt any_operand(size_t max_limbs) {
+        return operand(limb_count(max_limbs), static_cast<Shape>(below(SHAPE_COUNT)));
+    }
+
+    // Sizes cluster around the Karatsuba thresholds and their multiples
+    size_t limb_count(size_t max_limbs) {
+        size_t n;
+        if (below(3) == 0) {
+            size_t t = below(2) ? BigInt::karatsuba_mul_threshold : BigInt::karatsuba_sqr_threshold;
+            n = t * (1 + below(3)) + below(3) - 1;
+        } else {
+            n = 1 + below(max_limbs);
+        }
+        return std::max<size_t>(1, std::min(n, max_limbs));
+    }
+
+private:
+    std::mt19937_64 gen;
+};
+
+struct Tally {
+    uint64_t runs = 0;
+    uint64_t failures = 0;
+};
+
+static std::map<std::string, Tally> tallies;
+
+static void check(const std::string& name, const BigInt& got, const BigInt& want,
+                  std::initializer_list<std::pair<const char*, const BigInt*>> inputs) {
+    Tally& tally = tallies[name];
+    tally.runs++;
+    if (got == want) return;
+    if (tally.failures++ >= 3) return; // Report the first few of each kind
+    std::cerr << "MISMATCH " << name << " (mul threshold " << BigInt::karatsuba_mul_threshold
+              << ", sqr threshold " << BigInt::karatsuba_sqr_threshold
+              << ", parallel threshold " << BigInt::parallel_mul_threshold << ")" << std::endl;
+    for (const auto& input : inputs) {
+        std::cerr << "    " << input.first << " = " << (input.second->neg ? "-" : "")
+                  << input.second->to_reversed_hex_string() << std::endl;
+    }
+    std::cerr << "    got  = " << (got.neg ? "-" : "") << got.to_reversed_hex_string() << std::endl;
+    std::cerr << "    want = " << (want.neg ? "-" : "") << want.to_reversed_hex_string() << std::endl;
+}
+
+static void check_arithmetic(OperandSource& src, size_t max_limbs) {
+    BigInt a = src.any_operand(max_limbs);
+    BigInt b = src.any_operand(max_limbs);
+    if (src.below(4) == 0) a = -a;
+    if (src.below(4) == 0) b = -b;
+
+    check("add", a + b, reference_add(a, b), {{"a", &a}, {"b", &b}});
+    check("sub", a - b, reference_sub(a, b), {{"a", &a}, {"b", &b}});
+    check("mul", a * b, reference_mul(a, b), {{"a", &a}, {"b", &b}});
+    check("sqr", a * a, reference_mul(a, a), {{"a", &a}});
+
+    size_t shift = src.below(3 * 64);
+    check("shl", a << shift, reference_shl(a, shift), {{"a", &a}});
+    check("shr", a >> shift, reference_shr(a, shift), {{"a", &a}});
+
+    uint32_t small = static_cast<uint32_t>(src.next() | 1);
+    check("mod_small", BigInt(static_cast<int64_t>(a.mod_small(small))),
+          reference_divmod(a.abs(), BigInt(static_cast<int64_t>(small))).second, {{"a", &a}});
+
+    // Divisors with the top bit set are where long division estimates go wrong
+    BigInt d = src.any_operand(max_limbs);
+    if (src.below(2) == 0) d = src.operand(d.limbs.size(), SHAPE_TOP_BIT);
+    if (d.is_zero()) d = BigInt(1);
+    if (src.below(4) == 0) d = -d;
+    BigInt u = src.below(2) ? a : a * d + src.any_operand(d.limbs.size());
+    auto fast = BigInt::divmod(u, d);
+    auto slow = reference_divmod(u, d);
+    check("div", fast.first, slow.first, {{"u", &u}, {"d", &d}});
+    check("mod", fast.second, slow.second, {{"u", &u}, {"d", &d}});
+}
+
+static void check_modular(OperandSource& src, size_t max_limbs) {
+    BigInt m = src.any_operand(max_limbs);
+    m.limbs[0] |= 1;
+    if (m <= BigInt(1)) m = BigInt(3);
+    BigInt a = reference_divmod(src.any_operand(max_limbs), m).second;
+    BigInt b = reference_divmod(src.any_operand(max_limbs), m).second;
+
+    MontgomeryContext ctx(m);
+    size_t n = ctx.limbs();
+    LimbVector am(n), bm(n), rm(n);
+    ctx.to_montgomery(a, am.data());
+    ctx.to_montgomery(b, bm.data());
+    BigInt back;
+    ctx.from_montgomery(am.data(), back);
+    check("montgomery_roundtrip", back, a, {{"m", &m}, {"a", &a}});
+
+    ctx.mul(am.data(), bm.data(), rm.data());
+    BigInt product;
+    ctx.from_montgomery(rm.data(), product);
+    check("montgomery_mul", product, reference_divmod(reference_mul(a, b), m).second, {{"m", &m}, {"a", &a}, {"b", &b}});
+    ctx.mul_parallel(am.data(), bm.data(), rm.data(), 1 + src.below(4));
+    ctx.from_montgomery(rm.data(), product);
+    check("montgomery_mul_parallel", product, reference_divmod(reference_mul(a, b), m).second, {{"m", &m}, {"a", &a}, {"b", &b}});
+
+    // Exponents stay short: the reference pays a bit-serial division per bit
+    BigInt e = src.operand(1 + src.below(2), static_cast<Shape>(src.below(SHAPE_COUNT)));
+    if (src.below(8) == 0) e = BigInt(src.below(3));
+    BigInt want = reference_powmod(a, e, m);
+    BigInt got;
+    ctx.pow(a, e, got);
+    check("montgomery_pow", got, want, {{"m", &m}, {"a", &a}, {"e", &e}});
+    check("powmod_odd", powMod(a, e, m), want, {{"m", &m}, {"a", &a}, {"e", &e}});
+
+    BigInt even = m + BigInt(1);
+    check("powmod_even", powMod(a, e, even), reference_powmod(a, e, even), {{"m", &even}, {"a", &a}, {"e", &e}});
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t iterations = 1000;
+    uint64_t seed = 1;
+    size_t max_limbs = 160;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        bool has_value = i + 1 < argc;
+        if (flag == "--iterations" && has_value) iterations = std::strtoull(argv[++i], nullptr, 10);
+        else if (flag == "--seed" && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (flag == "--max-limbs" && has_value) max_limbs = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--iterations N] [--seed S] [--max-limbs L]" << std::endl;
+            return 1;
+        }
+    }
+
+    const size_t default_mul = BigInt::karatsuba_mul_threshold;
+    const size_t default_sqr = BigInt::karatsuba_sqr_threshold;
+    const size_t default_parallel = BigInt::parallel_mul_threshold;
+    const size_t default_powmod = MontgomeryContext::parallel_limbs;
+    const size_t threshold_sets[][4] = {{default_mul, default_sqr, default_parallel, default_powmod},
+                                        {4, 4, 16, 1}, {8, 5, 32, 5}, {5, 12, default_parallel, default_powmod}};
+
+    OperandSource src(seed);
+    for (uint64_t it = 0; it < iterations; ++it) {
+        const size_t* t = threshold_sets[it % (sizeof(threshold_sets) / sizeof(threshold_sets[0]))];
+        BigInt::karatsuba_mul_threshold = t[0];
+        BigInt::karatsuba_sqr_threshold = t[1];
+        BigInt::parallel_mul_threshold = t[2];
+        MontgomeryContext::parallel_limbs = t[3];
+        check_arithmetic(src, max_limbs);
+        if (it % 4 == 0) check_modular(src, std::min<size_t>(max_limbs, 24));
+    }
+    BigInt::karatsuba_mul_threshold = default_mul;
+    BigInt::karatsuba_sqr_threshold = default_sqr;
+    BigInt::parallel_mul_threshold = default_parallel;
+    MontgomeryContext::parallel_limbs = default_powmod;
+
+    uint64_t failures = 0;
+    for (const auto& entry : tallies) {
+        std::cout << entry.first << ": " << entry.second.runs << " checks, " << entry.second.failures << " mismatches" << std::endl;
+        failures += entry.second.failures;
+    }
+    std::cout << (failures ? "FAIL" : "OK") << " (seed " << seed << ")" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+#ifndef WIENER_H
+#define WIENER_H
+
+#include "bigInt.h"
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Checks if x is a perfect square. Stores the root in root when it is.
+ */
+bool is_perfect_square(const BigInt& x, BigInt& root) {
+    if (x.neg) return false;
+
+    // Squares only hit 12 of the 64 residues mod 64, so most candidates
+    // are rejected from the lowest limb without calling isqrt.
+    static const uint64_t squares_mod_64 = 0x0202021202030213ULL;
+    if (((squares_mod_64 >> (x.limbs[0] & 63)) & 1) == 0) return false;
+
+    // One pass of mod_small over 63 * 65 * 11 = 45045 leaves about 1 in 30
+    // of what passed mod 64, before the (bit-serial) isqrt
+    struct Residues {
+        bool mod63[63] = {}, mod65[65] = {}, mod11[11] = {};
+        Residues() {
+            for (unsigned i = 0; i < 63; ++i) mod63[i * i % 63] = true;
+            for (unsigned i = 0; i < 65; ++i) mod65[i * i % 65] = true;
+            for (unsigned i = 0; i < 11; ++i) mod11[i * i % 11] = true;
+        }
+    };
+    static const Residues squares;
+    uint32_t r = x.mod_small(45045);
+    if (!squares.mod63[r % 63] || !squares.mod65[r % 65] || !squares.mod11[r % 11]) return false;
+
+    root = BigInt::isqrt(x);
+    return root * root == x;
+}
+
+// The 64 bits of x's magnitude from bit `shift` up
+uint64_t wiener_bits_at(const BigInt& x, size_t shift) {
+    size_t limb = shift / 64, bit = shift % 64;
+    if (limb >= x.limbs.size()) return 0;
+    uint64_t low = x.limbs[limb] >> bit;
+    if (bit == 0 || limb + 1 >= x.limbs.size()) return low;
+    return low | (x.limbs[limb + 1] << (64 - bit));
+}
+
+/**
+ * @brief The partial quotient a / b (a >= b > 0) from the leading 64 bits of
+ * both, Lehmer style: a / b lies between ah / (bh + 1) and (ah + 1) / bh, and
+ * when both round down to the same word that word is the quotient. Returns
+ * false when the leading words do not settle it, or it needs more than a word.
+ */
+bool wiener_leading_quotient(const BigInt& a, const BigInt& b, uint64_t& q) {
+    size_t a_bits = a.bit_length();
+    size_t shift = a_bits > 64 ? a_bits - 64 : 0;
+    uint64_t ah = wiener_bits_at(a, shift), bh = wiener_bits_at(b, shift);
+    if (bh == 0) return false;
+    if (shift == 0) {
+        q = ah / bh; // Both fit in a word: exact
+        return true;
+    }
+    if (ah == UINT64_MAX || bh == UINT64_MAX) return false; // The bounds would overflow
+    q = ah / (bh + 1);
+    return q == (ah + 1) / bh;
+}
+
+/**
+ * @brief w[0..wn) -= q * y[0..yn) for wn >= yn. Returns false when the result
+ * would be negative (w is then left with the wrapped-around value).
+ */
+bool wiener_sub_mul(uint64_t* w, size_t wn, const uint64_t* y, size_t yn, uint64_t q) {
+    uint64_t carry = 0, borrow = 0;
+    for (size_t i = 0; i < wn; ++i) {
+        if (i >= yn && carry == 0 && borrow == 0) return true;
+        uint64_t product = i < yn ? BigInt::mul_add(y[i], q, 0, carry) : carry;
+        if (i >= yn) carry = 0;
+        uint64_t diff = w[i] - product;
+        uint64_t b1 = w[i] < product;
+        w[i] = diff - borrow;
+        borrow = b1 | (diff < borrow);
+    }
+    return carry == 0 && borrow == 0;
+}
+
+/**
+ * @brief x += q * y for a one-word q, without temporaries.
+ */
+void wiener_add_mul(BigInt& x, const BigInt& y, uint64_t q) {
+    x.limbs.resize(std::max(x.limbs.size(), y.limbs.size()) + 1, 0);
+    uint64_t carry = 0, add = 0;
+    size_t i = 0;
+    for (; i < y.limbs.size(); ++i) {
+        uint64_t product = BigInt::mul_add(y.limbs[i], q, 0, carry);
+        x.limbs[i] = BigInt::add_carry(x.limbs[i], product, add);
+    }
+    for (; (carry || add) && i < x.limbs.size(); ++i) {
+        uint64_t high = carry;
+        carry = 0;
+        x.limbs[i] = BigInt::add_carry(x.limbs[i], high, add);
+    }
+    x.normalize();
+}
+
+/**
+ * @brief Exact division: stores m / k in q and returns true when k divides m
+ * (both positive). Works from the low word up with the inverse of k mod 2^64
+ * (Jebelean's method), so a failed test costs one schoolbook pass instead of
+ * a long division.
+ */
+bool wiener_divide_exact(const BigInt& m, const BigInt& k, BigInt& q) {
+    // Strip the power of two of k; m must have at least as many
+    auto trailing_zeros = [](const BigInt& x) {
+        size_t limb = 0;
+        while (x.limbs[limb] == 0) limb++;
+        return limb * 64 + static_cast<size_t>(__builtin_ctzll(x.limbs[limb]));
+    };
+    size_t zeros = trailing_zeros(k);
+    if (trailing_zeros(m) < zeros) return false;
+    BigInt u = zeros ? m >> zeros : m;
+    BigInt v = zeros ? k >> zeros : k;
+    if (u < v) return false; // m > 0 here, so the quotient would be a fraction
+
+    // v0 * inverse = 1 mod 2^64; each Newton step doubles the correct bits
+    uint64_t v0 = v.limbs[0], inverse = v0;
+    for (int i = 0; i < 5; ++i) inverse *= 2 - v0 * inverse;
+
+    size_t un = u.limbs.size(), vn = v.limbs.size();
+    size_t qn = un - vn + 1;
+    q.limbs.assign(qn, 0);
+    q.neg = false;
+    for (size_t i = 0; i < qn; ++i) {
+        uint64_t digit = u.limbs[i] * inverse;
+        q.limbs[i] = digit;
+        if (!wiener_sub_mul(&u.limbs[i], un - i, v.limbs.data(), vn, digit)) return false;
+    }
+    for (uint64_t limb : u.limbs) {
+        if (limb != 0) return false;
+    }
+    q.normalize();
+    return true;
+}
+
+/**
+ * @brief Wiener's attack: recovers a small private exponent d from (n, e).
+ * Walks the convergents k/d of the continued fraction of e/n. A convergent is
+ * accepted when phi = (e*d - 1)/k is an integer and z^2 - (n - phi + 1)z + n
+ * has integer roots (the primes p and q).
+ * The partial quotients come from the leading words (wiener_leading_quotient)
+ * and the remainders are updated a word at a time; divmod only runs when the
+ * leading words are ambiguous. Since e*d_i - n*k_i = (-1)^i * r_i, with r_i
+ * the Euclidean remainder after step i, phi = n - (r_i + 1)/k_i on odd steps
+ * and phi >= n on even ones, so the phi test is an exact division of the
+ * remainder rather than a division of e*d.
+ * Returns true and stores d when the attack succeeds.
+ */
+bool wiener_attack(const BigInt& n, const BigInt& e, BigInt& d) {
+    if (n <= BigInt(0) || e <= BigInt(0)) return false;
+
+    // Wiener's bound is d < n^(1/4) / 3; a couple of spare bits keep the
+    // cut-off safe while still stopping long before the expansion ends.
+    size_t max_d_bits = n.bit_length() / 4 + 2;
+
+    BigInt one(1), four(4);
+    BigInt a = e, b = n;
+    BigInt k_prev(1), k_prev2(0); // numerators of the convergents
+    BigInt d_prev(0), d_prev2(1); // denominators of the convergents
+    BigInt t, root;
+
+    for (size_t i = 0; !b.is_zero(); ++i) {
+        // a, b = b, a mod b, with the convergents advanced by the quotient
+        uint64_t q;
+        if (a < b) {
+            std::swap(k_prev, k_prev2); // q = 0
+            std::swap(d_prev, d_prev2);
+        } else if (wiener_leading_quotient(a, b, q)) {
+            wiener_sub_mul(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size(), q);
+            a.normalize();
+            wiener_add_mul(k_prev2, k_prev, q);
+            wiener_add_mul(d_prev2, d_prev, q);
+            std::swap(k_prev, k_prev2);
+            std::swap(d_prev, d_prev2);
+        } else {
+            std::pair<BigInt, BigInt> qr = BigInt::divmod(a, b);
+            a = std::move(qr.second);
+            k_prev2 = qr.first * k_prev + k_prev2;
+            d_prev2 = qr.first * d_prev + d_prev2;
+            std::swap(k_prev, k_prev2);
+            std::swap(d_prev, d_prev2);
+        }
+        std::swap(a, b);
+        const BigInt& k = k_prev;
+        const BigInt& dk = d_prev;
+
+        if (dk.bit_length() > max_d_bits) break;
+        if (i % 2 == 0 || k.is_zero()) continue;
+
+        // p + q = n - phi + 1 = (b + 1)/k + 1 must be a whole number
+        if (!wiener_divide_exact(b + one, k, t)) continue;
+        BigInt s = t + one;
+        BigInt disc = s * s - four * n;
+        if (disc.neg || !is_perfect_square(disc, root)) continue;
+        if ((s + root).is_even()) {
+            d = dk;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Classifies how exposed a known private exponent d is for modulus n.
+ * 0: safe, 1: below the Boneh-Durfee bound n^0.292 (lattice attack),
+ * 2: below the Wiener bound n^0.25 (continued-fraction attack).
+ */
+int small_d_severity(const BigInt& n, const BigInt& d) {
+    size_t n_bits = n.bit_length();
+    size_t d_bits = d.bit_length();
+    if (d_bits * 4 <= n_bits) return 2;
+    if (d_bits * 1000 <= n_bits * 292) return 1;
+    return 0;
+}
+
+#endif // WIENER_H
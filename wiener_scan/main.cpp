@@ -0,0 +1,47 @@
+#include "../bigInt.h"
+#include "../wiener.h"
+#include "../driver.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+
+// Scans a key inventory of (n, e) pairs for private exponents that
+// Wiener's attack recovers. Each output line is the recovered d, or -1.
+//     wiener_scan <input_file> <output_file>
+// An inventory is a --bulk file of two-field requests, so a plain run goes
+// through the --pipeline stages and attacks keys on every core. The other
+// driver modes (--bulk, --batch, --batch-async, --stream; see driver.h) take
+// the same input.
+
+static std::atomic<size_t> scanned(0), vulnerable(0);
+
+// Reads n and e and writes d, or -1 when the attack fails
+void wiener_compute(std::vector<BigInt>& values) {
+    BigInt d;
+    scanned++;
+    if (wiener_attack(values[0], values[1], d)) {
+        vulnerable++;
+        values.assign(1, d);
+    } else {
+        values.clear();
+    }
+}
+
+// Every (n, e) pair of the input, one answer line each
+void solve_inventory(std::istream& in, std::ostream& out) {
+    while ((in >> std::ws).peek() != std::char_traits<char>::eof()) {
+        solve_with_fields(in, out, {2, wiener_compute});
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<char*> args(argv, argv + argc);
+#if defined(__cpp_impl_coroutine)
+    static char pipeline[] = "--pipeline";
+    if (argc == 3 && argv[1][0] != '-') args.insert(args.begin() + 1, pipeline);
+#endif
+    int status = driver_main(static_cast<int>(args.size()), args.data(), solve_inventory, {2, wiener_compute, "wiener"});
+    std::cerr << "Scanned " << scanned << " keys, " << vulnerable << " vulnerable" << std::endl;
+    return status;
+}
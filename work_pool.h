@@ -0,0 +1,205 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+// Work-stealing thread pool for fork-join parallelism inside one request, such
+// as the sub-products of a large Karatsuba multiplication. Every worker owns a
+// deque: it pushes and pops its own tasks at the back (newest first, which
+// keeps recursive splits cache-warm) and steals from the front of the others'
+// (oldest first, which are the largest pieces). A thread waiting on a
+// TaskGroup runs queued tasks instead of sleeping, so nested groups cannot
+// deadlock and the waiting thread counts as one more worker.
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <cstdlib>
+
+class WorkPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkPool(size_t workers) {
+        for (size_t i = 0; i < workers; ++i) queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 0; i < workers; ++i) {
+            threads.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~WorkPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    /**
+     * @brief The process-wide pool: BIGINT_THREADS threads in total when that
+     * is set, otherwise one per hardware thread. The thread that waits on a
+     * group is one of them, so the pool itself starts one fewer.
+     */
+    static WorkPool& shared() {
+        static WorkPool pool(shared_workers());
+        return pool;
+    }
+
+    size_t workers() const { return threads.size(); }
+
+    // Queues a task on the calling worker's deque, or round-robin from outside the pool
+    void submit(Task task) {
+        size_t index = (current_pool() == this) ? current_index() : next_queue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        { std::lock_guard<std::mutex> lock(sleep_mutex); } // A worker between its check and its wait sees the task
+        wake.notify_one();
+    }
+
+    // Runs one queued task on the calling thread; false when there was none
+    bool run_one() {
+        Task task;
+        if (!take(current_pool() == this ? current_index() : queues.size(), task)) return false;
+        task();
+        return true;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static size_t shared_workers() {
+        const char* env = std::getenv("BIGINT_THREADS");
+        long threads = env ? std::atol(env) : static_cast<long>(std::thread::hardware_concurrency());
+        return threads > 1 ? static_cast<size_t>(threads - 1) : 0;
+    }
+
+    static WorkPool*& current_pool() {
+        static thread_local WorkPool* pool = nullptr;
+        return pool;
+    }
+    static size_t& current_index() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    // Own deque from the back first, then the others from the front
+    bool take(size_t own, Task& task) {
+        if (queued.load(std::memory_order_acquire) == 0) return false;
+        if (own < queues.size()) {
+            std::lock_guard<std::mutex> lock(queues[own]->mutex);
+            if (!queues[own]->tasks.empty()) {
+                task = std::move(queues[own]->tasks.back());
+                queues[own]->tasks.pop_back();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (size_t k = 1; k <= queues.size(); ++k) {
+            size_t victim = (own + k) % queues.size();
+            if (victim == own) continue;
+            std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+            if (!queues[victim]->tasks.empty()) {
+                task = std::move(queues[victim]->tasks.front());
+                queues[victim]->tasks.pop_front();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t index) {
+        current_pool() = this;
+        current_index() = index;
+        while (true) {
+            Task task;
+            if (take(index, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+            if (stopping) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> next_queue{0};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+/**
+ * @brief A set of tasks to fork on a WorkPool and join with wait(). With no
+ * pool workers the tasks simply run inline. The first exception a task throws
+ * is rethrown by wait().
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkPool& pool = WorkPool::shared()) : pool(pool) {}
+
+    ~TaskGroup() {
+        // Tasks reference the group; never leave them running behind it
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (!pool.run_one()) std::this_thread::yield();
+        }
+    }
+
+    void run(WorkPool::Task task) {
+        if (pool.workers() == 0) {
+            invoke(task);
+            return;
+        }
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.submit([this, task = std::move(task)] {
+            invoke(task);
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        });
+    }
+
+    void wait() {
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (!pool.run_one()) std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    void invoke(const WorkPool::Task& task) {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    WorkPool& pool;
+    std::atomic<size_t> pending{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+#endif // WORK_POOL_H